@@ -1,7 +1,9 @@
-import pyfasterac as pyf
 import ROOT
 import os
+import sys
 import numpy as np
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+import fastarrays
 
 # Known sources and gamma energies (keV)
 sources = {
@@ -32,24 +34,32 @@ def get_peak_centroid(hist, peak_guess, window=20):
     centroid = hist.GetBinCenter(max_bin)
     return centroid
 
+# Hits of detectors 1 and 2 (label % 1000), one numpy array of charges each
+def detector_charges(file_path):
+    hits = fastarrays.read_arrays(file_path)
+    det_id = hits.label % 1000
+    return {det: np.ascontiguousarray(hits.q[det_id == det], dtype=np.float64) for det in (1, 2)}
+
+def fill(hist, values):
+    if len(values):
+        hist.FillN(len(values), values, np.ones(len(values)))
+
 # Prepare per-detector data containers
 channels = {1: [], 2: []}
 energies = {1: [], 2: []}
+peak_hists = {1: [], 2: []}   # (histogram, E_gamma, centroid) for the resolution fit
 
-# Determine max_q across all files for optimal binning
+# Determine max_q across all files for optimal binning (files read once)
+charges = {}
 max_q = 0
 for source in sources:
     file_path = file_template.format(source=source)
     if not os.path.exists(file_path):
         continue
-    reader_tmp = pyf.fastreader(file_path)
-    while reader_tmp.get_next_event():
-        event = reader_tmp.get_event()
-        for sub_event in event.sub_events:
-            det_id = sub_event.label % 1000
-            if det_id in [1, 2]:
-                if sub_event.q > max_q:
-                    max_q = sub_event.q
+    charges[source] = detector_charges(file_path)
+    for q in charges[source].values():
+        if len(q):
+            max_q = max(max_q, q.max())
 
 print(f"Maximum q across all files: {max_q:.1f}")
 
@@ -65,7 +75,6 @@ for source, gammas in sources.items():
         continue
 
     print(f"Processing source: {source}")
-    reader = pyf.fastreader(file_path)
 
     # Create histograms per detector
     hist_det = {}
@@ -75,12 +84,8 @@ for source, gammas in sources.items():
                                   nbins, 0, max_q)
 
     # Fill histograms
-    while reader.get_next_event():
-        event = reader.get_event()
-        for sub_event in event.sub_events:
-            det_id = sub_event.label % 1000
-            if det_id in [1, 2]:
-                hist_det[det_id].Fill(sub_event.q)
+    for det in [1, 2]:
+        fill(hist_det[det], charges[source][det])
 
     # Extract centroids using old calibration for channel guess
     for det in [1, 2]:
@@ -90,6 +95,7 @@ for source, gammas in sources.items():
             print(f"  Detector {det} Gamma {E_gamma} keV → channel {centroid_q:.2f}")
             channels[det].append(centroid_q)
             energies[det].append(E_gamma)
+            peak_hists[det].append((hist_det[det], E_gamma, centroid_q))
 
         # Save histogram
         hist_det[det].SetDirectory(out_file)
@@ -125,5 +131,47 @@ for det in [1, 2]:
     c.SetGrid()
     c.SaveAs(f"calibration_detector_{det}.png")
 
+# Energy resolution per detector: Gaussian fit of each peak (sigma in keV
+# through the calibration slope), then sigma/E = a/sqrt(E) + b.
+# resolution.txt is read by the simulation (/detector/resolutionFile) and
+# by the offline smearing (geant4/Na22Compton/smear.py).
+resolution = {}
+for det in [1, 2]:
+    slope = calibration_tf1[det].GetParameter(0)
+    res_E, res_rel = [], []
+    for hist, E_gamma, centroid_q in peak_hists[det]:
+        half_width = 0.05 * E_gamma / slope   # about 1.5 sigma for NaI
+        f_gaus = ROOT.TF1(f"peak_det{det}_{E_gamma}", "gaus", centroid_q - half_width, centroid_q + half_width)
+        f_gaus.SetParameters(hist.GetBinContent(hist.FindBin(centroid_q)), centroid_q, half_width / 1.5)
+        if int(hist.Fit(f_gaus, "QRN")) != 0:
+            continue
+        sigma_E = abs(f_gaus.GetParameter(2)) * slope
+        res_E.append(float(E_gamma))
+        res_rel.append(sigma_E / E_gamma)
+        print(f"  Detector {det} Gamma {E_gamma} keV → sigma {sigma_E:.1f} keV ({100 * sigma_E / E_gamma:.2f} %)")
+    if len(res_E) < 2:
+        print(f"Detector {det}: not enough peaks for the resolution fit")
+        continue
+
+    graph = ROOT.TGraph(len(res_E), np.array(res_E, dtype=np.float64), np.array(res_rel, dtype=np.float64))
+    graph.SetName(f"graph_res_det{det}")
+    graph.SetTitle(f"Detector {det} resolution;Energy keV;#sigma/E")
+    graph.SetMarkerStyle(20)
+    graph.Write()
+
+    f_res = ROOT.TF1(f"resolution_det{det}", "[0]/sqrt(x) + [1]", 0, 2000)
+    f_res.SetParameters(0.8, 0.0)
+    graph.Fit(f_res, "Q")
+    f_res.Write()
+    resolution[det] = (f_res.GetParameter(0), f_res.GetParameter(1))
+    print(f"\nDetector {det} resolution: sigma/E = {resolution[det][0]:.4f} / sqrt(E) + {resolution[det][1]:.5f}")
+
+if resolution:
+    with open("resolution.txt", "w") as f:
+        f.write("# detector a b    (sigma/E = a/sqrt(E/keV) + b)\n")
+        for det, (a, b) in resolution.items():
+            f.write(f"{det} {a:.6g} {b:.6g}\n")
+    print("Resolution saved in resolution.txt")
+
 out_file.Close()
 print("Calibration saved in calibration.root")
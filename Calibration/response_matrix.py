@@ -1,7 +1,9 @@
-import pyfasterac as pyf
 import ROOT
 import os
+import sys
 import numpy as np
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+import fastarrays
 
 # --- 1. Paths to FAST files
 sources = {
@@ -36,21 +38,31 @@ calibration = {
     2: lambda q: f_cal_det2.Eval(q)
 }
 
+# Same calibrations on whole arrays ([0]*x + [1], as fitted by calibration.py)
+def calibrate(det_id, q):
+    f = f_cal_det1 if det_id == 1 else f_cal_det2
+    return f.GetParameter(0) * q + f.GetParameter(1)
 
-# --- 4. Determine global q range per detector for optimal binning
+# Hits of detectors 1 and 2 (label % 1000), one numpy array of charges each
+def detector_charges(file_path):
+    hits = fastarrays.read_arrays(file_path)
+    det_id = hits.label % 1000
+    return {det: np.ascontiguousarray(hits.q[det_id == det], dtype=np.float64) for det in (1, 2)}
+
+
+# --- 4. Determine global q range per detector for optimal binning (files read once)
+charges = {}
 qmin = {1: float('inf'), 2: float('inf')}
 qmax = {1: 0, 2: 0}
-for file_path in sources.values():
+for isotope, file_path in sources.items():
     if not os.path.exists(file_path):
         continue
-    reader = pyf.fastreader(file_path)
-    while reader.get_next_event():
-        event = reader.get_event()
-        for sub_event in event.sub_events:
-            det_id = sub_event.label % 1000
-            if det_id in [1,2]:
-                qmin[det_id] = min(qmin[det_id], sub_event.q)
-                qmax[det_id] = max(qmax[det_id], sub_event.q)
+    charges[isotope] = detector_charges(file_path)
+    for det_id in [1,2]:
+        q = charges[isotope][det_id]
+        if len(q):
+            qmin[det_id] = min(qmin[det_id], q.min())
+            qmax[det_id] = max(qmax[det_id], q.max())
 
 print(f"Global q ranges: Detector1: {qmin[1]:.1f}-{qmax[1]:.1f}, Detector2: {qmin[2]:.1f}-{qmax[2]:.1f}")
 
@@ -77,12 +89,9 @@ for isotope, file_path in sources.items():
                            nbins, e_min, e_max)
 
         # Fill energy histogram
-        reader = pyf.fastreader(file_path)
-        while reader.get_next_event():
-            event = reader.get_event()
-            for sub_event in event.sub_events:
-                if sub_event.label % 1000 == det_id:
-                    hist_e.Fill(calibration[det_id](sub_event.q))
+        E = np.ascontiguousarray(calibrate(det_id, charges[isotope][det_id]))
+        if len(E):
+            hist_e.FillN(len(E), E, np.ones(len(E)))
 
         histograms_energy[det_id][isotope] = hist_e
         hist_e.Write()
@@ -1,4 +1,4 @@
-import pyfasterac as pyf
+import fastarrays
 import ROOT
 import os
 import numpy as np
@@ -42,25 +42,32 @@ def get_peak_centroid(hist, peak_guess, window=20):
     peak_counts = hist.GetBinContent(max_bin)
     return centroid, peak_counts
 
+# Hits of detectors 1 and 2 (label % 1000), one numpy array of charges each
+def detector_charges(file_path):
+    hits = fastarrays.read_arrays(file_path)
+    det_id = hits.label % 1000
+    return {det: np.ascontiguousarray(hits.q[det_id == det], dtype=np.float64) for det in (1, 2)}
+
+def fill(hist, values):
+    if len(values):
+        hist.FillN(len(values), values, np.ones(len(values)))
+
 # Prepare per-detector data containers
 channels = {1: [], 2: []}
 energies = {1: [], 2: []}
 maximum = {1: [], 2: []}
 
-# Determine max_q across all files for optimal binning
+# Determine max_q across all files for optimal binning (files read once)
+charges = {}
 max_q = 0
 for source in sources:
     file_path = file_template.format(source=source)
     if not os.path.exists(file_path):
         continue
-    reader_tmp = pyf.fastreader(file_path)
-    while reader_tmp.get_next_event():
-        event = reader_tmp.get_event()
-        for sub_event in event.sub_events:
-            det_id = sub_event.label % 1000
-            if det_id in [1, 2]:
-                if sub_event.q > max_q:
-                    max_q = sub_event.q
+    charges[source] = detector_charges(file_path)
+    for q in charges[source].values():
+        if len(q):
+            max_q = max(max_q, q.max())
 
 print(f"Maximum q across all files: {max_q:.1f}")
 
@@ -76,7 +83,6 @@ for source, gammas in sources.items():
         continue
 
     print(f"Processing source: {source}")
-    reader = pyf.fastreader(file_path)
 
     # Create histograms per detector
     hist_det = {}
@@ -86,12 +92,8 @@ for source, gammas in sources.items():
                                   nbins, 0, max_q)
 
     # Fill histograms
-    while reader.get_next_event():
-        event = reader.get_event()
-        for sub_event in event.sub_events:
-            det_id = sub_event.label % 1000
-            if det_id in [1, 2]:
-                hist_det[det_id].Fill(sub_event.q)
+    for det in [1, 2]:
+        fill(hist_det[det], charges[source][det])
 
     # Extract centroids using old calibration for channel guess
     for det in [1, 2]:
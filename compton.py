@@ -1,4 +1,4 @@
-import pyfasterac as pyf
+import fastarrays
 import ROOT
 from ROOT import Math
 import array
@@ -33,22 +33,24 @@ box_size = 20
 def build_histogram(file_path, nbins=200, e_max=2000):
     h2 = ROOT.TH2D("coinc", "Detector1 - Detector2;E1 (keV);E2 (keV)",
                    nbins, 0, e_max, nbins, 0, e_max)
-    reader = pyf.fastreader(file_path)
-    while reader.get_next_event():
-        event = reader.get_event()
-        if event.multiplicity < 2:
-            continue
-        E1_list, E2_list = [], []
-        for sub_event in event.sub_events:
-            det_id = sub_event.label % 1000
-            E = calibration.get(det_id, lambda q: 0)(sub_event.q)
-            if det_id == 1:
-                E1_list.append(E)
-            elif det_id == 2:
-                E2_list.append(E)
-        for E1 in E1_list:
-            for E2 in E2_list:
-                h2.Fill(E1, E2)
+    hits = fastarrays.read_arrays(file_path)
+    det_id = hits.label % 1000
+    E = np.zeros(len(hits))
+    for det, calib in calibration.items():
+        sel = det_id == det
+        E[sel] = calib(hits.q[sel])
+    keep = hits.multiplicity >= 2
+    event, det_id, E = hits.event[keep], det_id[keep], E[keep]
+    # every (E1, E2) pair of an event
+    i1 = np.flatnonzero(det_id == 1)
+    i2 = np.flatnonzero(det_id == 2)
+    first = np.searchsorted(event[i2], event[i1], "left")
+    count = np.searchsorted(event[i2], event[i1], "right") - first
+    j2 = np.repeat(first, count) + np.arange(count.sum()) - np.repeat(np.cumsum(count) - count, count)
+    E1 = np.ascontiguousarray(E[np.repeat(i1, count)])
+    E2 = np.ascontiguousarray(E[i2[j2]])
+    if len(E1):
+        h2.FillN(len(E1), E1, E2, np.ones(len(E1)))
     return h2
 
 def analyze_peak(hist2d, box_size=20):
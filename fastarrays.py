@@ -0,0 +1,187 @@
+"""
+Whole-file numpy arrays of faster data, decoded in C by libfasterac (fcolumns).
+
+    import fastarrays
+    a = fastarrays.read_arrays("compton_45.fast")     # .fast, .fast.gz or .fcol
+    a.label, a.clock, a.q, a.flags                    # one entry per hit (groups flattened)
+    a.event, a.multiplicity                           # event index and size of each hit
+    g, stats = fastarrays.coincidences(a, window_ns=50, delay_ns=1000)
+
+The decoding runs in libfasterac with the GIL released (ctypes) and the
+arrays are views of the C columns (no copy). A '.fcol' file written by
+faster_file_columns is memory mapped.
+libfasterac is looked for in $FASTERAC_LIB, then pyfasterac/install/lib,
+then in the system library path. Without a libfasterac built with fcolumns,
+the arrays are filled from the pyfasterac reader (slower, one Python object
+per hit ; clock is the sub-event time given by pyfasterac).
+"""
+import ctypes
+import ctypes.util
+import os
+import numpy as np
+
+# ------------------------
+# libfasterac
+# ------------------------
+SATURATED   = 0x01
+PILEUP      = 0x02
+GROUP_START = 0x04
+IN_GROUP    = 0x08
+
+class _fcoinc_stats(ctypes.Structure):
+    _fields_ = [("nb_hits",         ctypes.c_ulonglong),
+                ("nb_late",         ctypes.c_ulonglong),
+                ("nb_windows",      ctypes.c_ulonglong),
+                ("nb_groups",       ctypes.c_ulonglong),
+                ("nb_accidentals",  ctypes.c_ulonglong),
+                ("first_ns",        ctypes.c_ulonglong),
+                ("last_ns",         ctypes.c_ulonglong),
+                ("group_rate",      ctypes.c_double),
+                ("accidental_rate", ctypes.c_double)]
+
+class _fcolumns(ctypes.Structure):
+    _fields_ = [("nb_data",  ctypes.c_ulonglong),
+                ("label",    ctypes.POINTER(ctypes.c_ushort)),
+                ("clock_ns", ctypes.POINTER(ctypes.c_ulonglong)),
+                ("q",        ctypes.POINTER(ctypes.c_int)),
+                ("flags",    ctypes.POINTER(ctypes.c_ubyte)),
+                ("map",      ctypes.c_void_p),
+                ("map_size", ctypes.c_size_t),
+                ("max_data", ctypes.c_ulonglong)]
+
+def _load_library():
+    here = os.path.dirname(os.path.abspath(__file__))
+    candidates = [os.environ.get("FASTERAC_LIB"),
+                  os.path.join(here, "pyfasterac", "install", "lib", "libfasterac.so"),
+                  os.path.join(here, "pyfasterac", "install", "lib", "libfasterac.dylib"),
+                  ctypes.util.find_library("fasterac")]
+    for path in candidates:
+        if not path:
+            continue
+        try:
+            lib = ctypes.CDLL(path)
+            lib.fcolumns_from_fast
+        except (OSError, AttributeError):
+            continue
+        for name in ("fcolumns_from_fast", "fcolumns_map"):
+            getattr(lib, name).argtypes = [ctypes.c_char_p, ctypes.POINTER(_fcolumns)]
+            getattr(lib, name).restype  = ctypes.c_int
+        lib.fcolumns_free.argtypes = [ctypes.POINTER(_fcolumns)]
+        lib.fcolumns_free.restype  = None
+        if hasattr(lib, "fcoinc_columns"):
+            lib.fcoinc_columns.argtypes = [ctypes.POINTER(_fcolumns), ctypes.c_ulonglong, ctypes.c_int,
+                                           ctypes.c_void_p, ctypes.c_ulonglong, ctypes.c_void_p,
+                                           ctypes.POINTER(_fcoinc_stats)]
+            lib.fcoinc_columns.restype  = ctypes.c_int
+        return lib
+    raise ImportError("libfasterac with fcolumns not found (set FASTERAC_LIB)")
+
+_lib = None
+_lib_error = None                                      # libfasterac not found => pyfasterac
+
+# ------------------------
+# Arrays
+# ------------------------
+class FastArrays:
+    """Columns of a file ; the C memory is freed with the last array using it."""
+
+    def __init__(self, path):
+        global _lib, _lib_error
+        self._col = None
+        if _lib is None and _lib_error is None:
+            try:
+                _lib = _load_library()
+            except ImportError as e:
+                _lib_error = e
+        if _lib is None:
+            if path.endswith(".fcol"):
+                raise _lib_error
+            self._from_pyfasterac(path)
+            return
+        self._col = _fcolumns()
+        load = _lib.fcolumns_map if path.endswith(".fcol") else _lib.fcolumns_from_fast
+        err = load(os.fsencode(path), ctypes.byref(self._col))
+        if err:
+            raise IOError(f"error {err} reading {path}")
+        n = self._col.nb_data
+        self.label = self._view(self._col.label,    ctypes.c_ushort,    np.uint16, n)
+        self.clock = self._view(self._col.clock_ns, ctypes.c_ulonglong, np.uint64, n)
+        self.q     = self._view(self._col.q,        ctypes.c_int,       np.int32,  n)
+        self.flags = self._view(self._col.flags,    ctypes.c_ubyte,     np.uint8,  n)
+        # a hit starts an event unless it follows a hit of its group
+        starts = ((self.flags & GROUP_START) != 0) | ((self.flags & IN_GROUP) == 0)
+        self.event = np.cumsum(starts, dtype=np.int64) - 1
+        self.multiplicity = np.bincount(self.event)[self.event] if n else np.zeros(0, dtype=np.int64)
+
+    def _from_pyfasterac(self, path):
+        import pyfasterac as pyf
+        label, clock, q, flags, event = [], [], [], [], []
+        reader = pyf.fastreader(path)
+        n_events = 0
+        while reader.get_next_event():
+            sub_events = reader.get_event().sub_events
+            grouped = len(sub_events) > 1
+            for k, sub_event in enumerate(sub_events):
+                label.append(sub_event.label)
+                clock.append(sub_event.time)
+                q.append(sub_event.q)
+                flags.append((IN_GROUP | (GROUP_START if k == 0 else 0)) if grouped else 0)
+                event.append(n_events)
+            n_events += 1
+        self.label = np.array(label, dtype=np.uint16)
+        self.clock = np.array(clock, dtype=np.uint64)
+        self.q     = np.array(q,     dtype=np.int32)
+        self.flags = np.array(flags, dtype=np.uint8)
+        self.event = np.array(event, dtype=np.int64)
+        self.multiplicity = np.bincount(self.event)[self.event] if len(event) else np.zeros(0, dtype=np.int64)
+
+    def _view(self, pointer, ctype, dtype, n):
+        if n == 0:
+            return np.zeros(0, dtype=dtype)
+        buf = (ctype * n).from_address(ctypes.addressof(pointer.contents))
+        buf._owner = self                                  # keeps the columns alive
+        array = np.frombuffer(buf, dtype=dtype)
+        array.flags.writeable = False
+        return array
+
+    def __len__(self):
+        return len(self.label)
+
+    def __del__(self):
+        if _lib is not None and getattr(self, "_col", None) is not None:
+            _lib.fcolumns_free(ctypes.byref(self._col))
+
+def read_arrays(path):
+    return FastArrays(path)
+
+# ------------------------
+# Coincidences
+# ------------------------
+def coincidences(arrays, window_ns, min_fold=2, offsets=None, delay_ns=0):
+    """
+    Software coincidences of the hits of 'arrays' (libfasterac fcoinc) :
+    a window of window_ns opens on the oldest free hit, its hits form a group
+    when there are at least min_fold of them. offsets is a {label: ns} dict
+    added to the clocks ; with delay_ns, the windows delayed by delay_ns count
+    the accidentals.
+    The hits must be time sorted (e.g. faster_file_sort), apart from the data
+    of a group : hits later than the largest group span are dropped and
+    counted in stats["nb_late"].
+    Returns (group, stats) : the group number of each hit (-1 if none) and a
+    dict of counters and rates.
+    """
+    if arrays._col is None or not hasattr(_lib, "fcoinc_columns"):
+        raise ImportError("libfasterac without fcoinc")
+    group = np.empty(len(arrays), dtype=np.int64)
+    table = None
+    if offsets:
+        table = np.zeros(65536, dtype=np.int64)
+        for label, offset in offsets.items():
+            table[label] = offset
+    stats = _fcoinc_stats()
+    err = _lib.fcoinc_columns(ctypes.byref(arrays._col), window_ns, min_fold,
+                              None if table is None else table.ctypes.data, delay_ns,
+                              group.ctypes.data, ctypes.byref(stats))
+    if err:
+        raise MemoryError(f"error {err} building coincidences")
+    return group, {name: getattr(stats, name) for name, _ in _fcoinc_stats._fields_}
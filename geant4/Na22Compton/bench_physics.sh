@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+#  Physics list benchmark: initialization time and events per second
+#  of the full (FTFP_BERT + EM option 4) and lean (EM only) lists.
+#
+#    ./bench_physics.sh [events] [threads]     (from the build directory)
+#
+
+EVENTS=${1:-100000}
+THREADS=${2:-1}
+MACRO=bench_physics.mac
+
+cat > $MACRO << END
+/run/verbose 0
+/event/verbose 0
+/tracking/verbose 0
+/run/printProgress 0
+/analysis/setFileName bench_physics
+/detector/setDet2Angle 180 deg
+/run/beamOn $EVENTS
+END
+
+for PHYSICS in full lean; do
+  echo "--- $PHYSICS physics, $EVENTS events, $THREADS thread(s)"
+  ./Na22Compton -t $THREADS -p $PHYSICS $MACRO | grep -E "^Initialization|^Run time|^Total coincidence events|^True 511keV"
+done
+
+rm -f $MACRO bench_physics*.root
@@ -1,12 +1,16 @@
-// ActionInitialization.cc - Updated to pass DetectorSD pointers to EventAction
+// ActionInitialization.cc - Per-thread user actions, run statistics merged on the master
 #include "ActionInitialization.hh"
 #include "EventAction.hh"
 #include "PrimaryGeneratorAction.hh"
+#include "RunAction.hh"
 
-ActionInitialization::ActionInitialization(DetectorSD* det1, DetectorSD* det2)
- : fDet1(det1), fDet2(det2) {}
+void ActionInitialization::BuildForMaster() const {
+    SetUserAction(new RunAction());
+}
 
 void ActionInitialization::Build() const {
+    auto runAction = new RunAction();
+    SetUserAction(runAction);
     SetUserAction(new PrimaryGeneratorAction());
-    SetUserAction(new EventAction(fDet1, fDet2));
+    SetUserAction(new EventAction(runAction));
 }
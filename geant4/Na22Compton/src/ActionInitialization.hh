@@ -1,15 +1,10 @@
 #pragma once
 #include "G4VUserActionInitialization.hh"
-#include "DetectorSD.hh"
 
 class ActionInitialization : public G4VUserActionInitialization {
 public:
-    ActionInitialization(DetectorSD* det1, DetectorSD* det2);
+    ActionInitialization() = default;
     ~ActionInitialization() override {}
+    void BuildForMaster() const override;
     void Build() const override;
-
-private:
-    DetectorSD* fDet1;
-    DetectorSD* fDet2;
 };
-
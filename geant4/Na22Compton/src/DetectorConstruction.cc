@@ -14,26 +14,35 @@
 #include "G4RunManager.hh"
 #include "G4UImanager.hh"
 #include "G4SDManager.hh"
+#include "G4GeometryManager.hh"
+#include "G4VVisManager.hh"
 
 #include "DetectorSD.hh"
 #include "DetectorMessenger.hh"
+#include "FastSimMessenger.hh"
+#include "NaIResponseModel.hh"
+
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
 
 #include <cmath>
+#include <sstream>
 
 DetectorConstruction::DetectorConstruction()
  : fWorld(nullptr), fWorldLogical(nullptr),
    fDet1Physical(nullptr), fDet1Logical(nullptr),
    fDet2Physical(nullptr), fDet2Logical(nullptr),
-   fDet1SD(nullptr), fDet2SD(nullptr),
    fDet2Angle(0.), fDet2Radius(17.4*cm),
-   fMessenger(nullptr) {
+   fMessenger(nullptr), fFastSimMessenger(nullptr) {
     
-    // Create messenger
+    // Create messengers
     fMessenger = new DetectorMessenger(this);
+    fFastSimMessenger = new FastSimMessenger();
 }
 
 DetectorConstruction::~DetectorConstruction() {
     delete fMessenger;
+    delete fFastSimMessenger;
     // Note: SDs are managed by G4SDManager, don't delete them here
 }
 
@@ -123,38 +132,40 @@ G4VPhysicalVolume* DetectorConstruction::Construct() {
     fDet2Physical = new G4PVPlacement(rot2, pos, fDet2Logical, "Det2", fWorldLogical, false, 0, true);
     fDet2Logical->SetVisAttributes(new G4VisAttributes(G4Colour::Red()));
 
-    return fWorld;
-}
+    // --- Envelope of the fast simulation model: both crystals ---
+    auto naiRegion = new G4Region("NaIRegion");
+    naiRegion->AddRootLogicalVolume(fDet1Logical);
+    naiRegion->AddRootLogicalVolume(fDet2Logical);
 
-void DetectorConstruction::ConstructSDandField() {
-    // Create sensitive detectors
-    fDet1SD = new DetectorSD("Det1SD");
-    fDet2SD = new DetectorSD("Det2SD");
+    // --- Lead shield: fine cuts of the lean physics list ---
+    auto leadRegion = new G4Region("LeadRegion");
+    leadRegion->AddRootLogicalVolume(block1LV);
+    leadRegion->AddRootLogicalVolume(block2LV);
 
-    // Register SDs with SDManager
-    G4SDManager::GetSDMpointer()->AddNewDetector(fDet1SD);
-    G4SDManager::GetSDMpointer()->AddNewDetector(fDet2SD);
-
-    // Attach SDs to logical volumes
-    fDet1Logical->SetSensitiveDetector(fDet1SD);
-    fDet2Logical->SetSensitiveDetector(fDet2SD);
+    return fWorld;
 }
 
-// Helper: remove and delete a PV safely
-static void SafeDeletePV(G4VPhysicalVolume* & pv) {
-    if(!pv) return;
-    if (pv->GetMotherLogical()) {
-        pv->GetMotherLogical()->RemoveDaughter(pv);
-    }
-    delete pv;
-    pv = nullptr;
+void DetectorConstruction::ConstructSDandField() {
+    // Called on each worker thread: the SDs are thread-local,
+    // the EventAction of the thread finds them by name
+    auto det1SD = new DetectorSD("Det1SD", 1);
+    auto det2SD = new DetectorSD("Det2SD", 2);
+
+    // Register SDs with the SDManager of the thread and attach them to the logical volumes
+    G4SDManager::GetSDMpointer()->AddNewDetector(det1SD);
+    G4SDManager::GetSDMpointer()->AddNewDetector(det2SD);
+    SetSensitiveDetector(fDet1Logical, det1SD);
+    SetSensitiveDetector(fDet2Logical, det2SD);
+
+    // Fast simulation of the crystals (thread-local, inactive without a table)
+    new NaIResponseModel("NaIResponse", G4RegionStore::GetInstance()->GetRegion("NaIRegion"));
 }
 
 void DetectorConstruction::SetDet2Angle(G4double angleDeg)
 {
     fDet2Angle = angleDeg;
 
-    if (!fDet1Physical || !fDet2Logical || !fWorldLogical) return;
+    if (!fDet1Physical || !fDet2Physical) return;
 
     G4ThreeVector det1Pos = fDet1Physical->GetTranslation();
 
@@ -169,7 +180,7 @@ void DetectorConstruction::SetDet2Angle(G4double angleDeg)
     // Orient Det2 axis perpendicular to Det1 (toward center)
     G4ThreeVector towardCenter = (det1Pos - pos).unit();
     
-    G4RotationMatrix* rot = new G4RotationMatrix();
+    G4RotationMatrix rot;
     
     // Default cylinder axis is along z, rotate to point toward center
     G4ThreeVector zAxis(0, 0, 1);
@@ -177,12 +188,35 @@ void DetectorConstruction::SetDet2Angle(G4double angleDeg)
     
     if (rotationAxis.mag() > 1e-6) {
         G4double rotationAngle = std::acos(zAxis.dot(towardCenter));
-        rot->rotate(rotationAngle, rotationAxis.unit());
+        rot.rotate(rotationAngle, rotationAxis.unit());
     }
 
-    SafeDeletePV(fDet2Physical);
-    fDet2Physical = new G4PVPlacement(rot, pos, fDet2Logical, "Det2", fWorldLogical, false, 0, true);
+    // Move the existing placement (shared by the worker threads): the
+    // geometry is reoptimised at the next run, physics tables are kept
+    G4GeometryManager::GetInstance()->OpenGeometry(fWorld);
+    *fDet2Physical->GetRotation() = rot;
+    fDet2Physical->SetTranslation(pos);
 
     G4RunManager::GetRunManager()->GeometryHasBeenModified();
-    G4UImanager::GetUIpointer()->ApplyCommand("/vis/viewer/update");
+    if (G4VVisManager::GetConcreteInstance()) {
+        G4UImanager::GetUIpointer()->ApplyCommand("/vis/viewer/update");
+    }
+}
+
+void DetectorConstruction::ScanAngles(G4double startDeg, G4double stopDeg, G4double stepDeg, G4int nEvents)
+{
+    if (stepDeg <= 0. || stopDeg < startDeg) return;
+
+    // One run (and one output file) per angle, in the same process
+    G4int nAngles = static_cast<G4int>(std::floor((stopDeg - startDeg) / stepDeg + 1e-6)) + 1;
+    for (G4int i = 0; i < nAngles; ++i) {
+        G4double angle = startDeg + i * stepDeg;
+        std::ostringstream fileName;
+        fileName << "Na22Compton_" << angle << "deg";
+
+        G4cout << "\n=== DETECTOR 2 AT " << angle << " deg ===" << G4endl;
+        SetDet2Angle(angle);
+        G4UImanager::GetUIpointer()->ApplyCommand("/analysis/setFileName " + fileName.str());
+        G4RunManager::GetRunManager()->BeamOn(nEvents);
+    }
 }
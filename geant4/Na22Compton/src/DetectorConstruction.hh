@@ -4,8 +4,8 @@
 #include "G4VPhysicalVolume.hh"
 #include "globals.hh"
 
-class DetectorSD;
 class DetectorMessenger;
+class FastSimMessenger;
 
 class DetectorConstruction : public G4VUserDetectorConstruction {
 public:
@@ -18,9 +18,8 @@ public:
     // Rotate second detector around first detector
     void SetDet2Angle(G4double angleDeg);
 
-    // Getters for SDs
-    DetectorSD* GetDet1SD() const { return fDet1SD; }
-    DetectorSD* GetDet2SD() const { return fDet2SD; }
+    // Run nEvents at each angle from startDeg to stopDeg
+    void ScanAngles(G4double startDeg, G4double stopDeg, G4double stepDeg, G4int nEvents);
 
 private:
     // World
@@ -38,10 +37,7 @@ private:
     G4double fDet2Angle;   // in degrees
     G4double fDet2Radius;  // distance from Det1
 
-    // Sensitive detectors
-    DetectorSD* fDet1SD;
-    DetectorSD* fDet2SD;
-
-    // Messenger
+    // Messengers
     DetectorMessenger* fMessenger;
+    FastSimMessenger* fFastSimMessenger;
 };
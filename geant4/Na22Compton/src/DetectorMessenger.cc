@@ -1,6 +1,12 @@
 #include "DetectorMessenger.hh"
 #include "DetectorConstruction.hh"
+#include "ResolutionModel.hh"
+#include "DetectorSD.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIparameter.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <sstream>
 
 DetectorMessenger::DetectorMessenger(DetectorConstruction* det)
  : fDetector(det) {
@@ -9,14 +15,86 @@ DetectorMessenger::DetectorMessenger(DetectorConstruction* det)
     fDet2AngleCmd->SetParameterName("angle", false);
     fDet2AngleCmd->SetUnitCategory("Angle");
     fDet2AngleCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fScanAnglesCmd = new G4UIcommand("/detector/scanAngles", this);
+    fScanAnglesCmd->SetGuidance("Run N events at each Detector 2 angle (deg) from start to stop.");
+    fScanAnglesCmd->SetGuidance("One output file per angle (Na22Compton_<angle>deg).");
+    auto startParam = new G4UIparameter("start", 'd', false);
+    auto stopParam = new G4UIparameter("stop", 'd', false);
+    auto stepParam = new G4UIparameter("step", 'd', false);
+    auto eventsParam = new G4UIparameter("N", 'i', false);
+    stepParam->SetParameterRange("step > 0.");
+    eventsParam->SetParameterRange("N >= 0");
+    fScanAnglesCmd->SetParameter(startParam);
+    fScanAnglesCmd->SetParameter(stopParam);
+    fScanAnglesCmd->SetParameter(stepParam);
+    fScanAnglesCmd->SetParameter(eventsParam);
+    fScanAnglesCmd->AvailableForStates(G4State_Idle);
+
+    // Resolution parameters are shared by the threads: master only
+    fResolutionCmd = new G4UIcommand("/detector/resolution", this);
+    fResolutionCmd->SetGuidance("Energy resolution of a detector: sigma/E = a/sqrt(E/keV) + b.");
+    auto detParam = new G4UIparameter("detector", 'i', false);
+    auto aParam = new G4UIparameter("a", 'd', false);
+    auto bParam = new G4UIparameter("b", 'd', false);
+    detParam->SetParameterCandidates("1 2");
+    aParam->SetParameterRange("a >= 0.");
+    bParam->SetParameterRange("b >= 0.");
+    fResolutionCmd->SetParameter(detParam);
+    fResolutionCmd->SetParameter(aParam);
+    fResolutionCmd->SetParameter(bParam);
+    fResolutionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    fResolutionCmd->SetToBeBroadcasted(false);
+
+    fResolutionFileCmd = new G4UIcmdWithAString("/detector/resolutionFile", this);
+    fResolutionFileCmd->SetGuidance("Read the energy resolution of the detectors (lines \"detector a b\"),");
+    fResolutionFileCmd->SetGuidance("e.g. resolution.txt written by Calibration/calibration.py.");
+    fResolutionFileCmd->SetParameterName("file", false);
+    fResolutionFileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    fResolutionFileCmd->SetToBeBroadcasted(false);
+
+    fMergeHitsCmd = new G4UIcmdWithABool("/detector/mergeHits", this);
+    fMergeHitsCmd->SetGuidance("One hit per track in the hits collections (false: one per step).");
+    fMergeHitsCmd->SetParameterName("merge", false);
+    fMergeHitsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    fMergeHitsCmd->SetToBeBroadcasted(false);
 }
 
 DetectorMessenger::~DetectorMessenger() {
     delete fDet2AngleCmd;
+    delete fScanAnglesCmd;
+    delete fResolutionCmd;
+    delete fResolutionFileCmd;
+    delete fMergeHitsCmd;
 }
 
 void DetectorMessenger::SetNewValue(G4UIcommand* command, G4String newValue) {
     if (command == fDet2AngleCmd) {
-        fDetector->SetDet2Angle(fDet2AngleCmd->GetNewDoubleValue(newValue));
+        // SetDet2Angle takes degrees, the command value is in internal units
+        fDetector->SetDet2Angle(fDet2AngleCmd->GetNewDoubleValue(newValue) / deg);
+    }
+    else if (command == fScanAnglesCmd) {
+        G4double start, stop, step;
+        G4int nEvents;
+        std::istringstream is(newValue);
+        is >> start >> stop >> step >> nEvents;
+        fDetector->ScanAngles(start, stop, step, nEvents);
+    }
+    else if (command == fResolutionCmd) {
+        G4int detector;
+        G4double a, b;
+        std::istringstream is(newValue);
+        is >> detector >> a >> b;
+        ResolutionModel::Set(detector, a, b);
+    }
+    else if (command == fResolutionFileCmd) {
+        if (!ResolutionModel::Load(newValue)) {
+            G4ExceptionDescription msg;
+            msg << "Cannot read the energy resolution from " << newValue;
+            command->CommandFailed(msg);
+        }
+    }
+    else if (command == fMergeHitsCmd) {
+        DetectorSD::SetMergeHits(fMergeHitsCmd->GetNewBoolValue(newValue));
     }
 }
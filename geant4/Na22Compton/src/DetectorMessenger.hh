@@ -2,6 +2,9 @@
 
 #include "G4UImessenger.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcommand.hh"
 
 class DetectorConstruction;
 
@@ -15,4 +18,8 @@ public:
 private:
     DetectorConstruction* fDetector;
     G4UIcmdWithADoubleAndUnit* fDet2AngleCmd;
+    G4UIcommand* fScanAnglesCmd;
+    G4UIcommand* fResolutionCmd;
+    G4UIcmdWithAString* fResolutionFileCmd;
+    G4UIcmdWithABool* fMergeHitsCmd;
 };
@@ -1,43 +1,142 @@
 // DetectorSD.cc - Fixed to match existing header interface
 #include "DetectorSD.hh"
+#include "NaIResponseTable.hh"
+#include "ResolutionModel.hh"
 #include "G4Step.hh"
 #include "G4Track.hh"
+#include "G4Gamma.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4SDManager.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4UnitsTable.hh"
-#include "Randomize.hh"
 #include "G4ios.hh"
 
-DetectorSD::DetectorSD(const G4String& name) 
+G4bool DetectorSD::fMergeHits = false;
+
+DetectorSD::DetectorSD(const G4String& name, G4int detectorID)
  : G4VSensitiveDetector(name),
+   fDetectorID(detectorID),
+   fHitsCollection(nullptr),
+   fHCID(-1),
    fTotalEdep(0.),
-   fEnergyResolution(0.08) // 8% energy resolution for NaI
-{}
+   fFirstPos(),
+   fFirstTime(0.),
+   fNbEntering(0), fEntryTrackID(-1), fEntryEnergy(0.),
+   fExitEnergy(0.)
+{
+    collectionName.insert("hits");
+}
+
+void DetectorSD::Initialize(G4HCofThisEvent* hce)
+{
+    // New collection for each event, owned (and deleted) by the event
+    fHitsCollection = new DetectorHitsCollection(SensitiveDetectorName, collectionName[0]);
+    if (fHCID < 0) fHCID = G4SDManager::GetSDMpointer()->GetCollectionID(fHitsCollection);
+    hce->AddHitsCollection(fHCID, fHitsCollection);
+}
 
 G4bool DetectorSD::ProcessHits(G4Step* step, G4TouchableHistory*) 
 {
+    // Photons entering and leaving the crystal (for the response table)
+    G4Track* track = step->GetTrack();
+    if (track->GetDefinition() == G4Gamma::Definition()) {
+        G4StepPoint* pre = step->GetPreStepPoint();
+        G4StepPoint* post = step->GetPostStepPoint();
+        if (pre->GetStepStatus() == fGeomBoundary && ++fNbEntering == 1) {
+            fEntryTrackID = track->GetTrackID();
+            fEntryEnergy = pre->GetKineticEnergy();
+            fEntryPos = pre->GetPosition();
+            fEntryDir = pre->GetMomentumDirection();
+            fLastInteraction = fEntryPos;
+        }
+        if (track->GetTrackID() == fEntryTrackID && fExitEnergy == 0.) {
+            // Interaction at the end of the step, except for the step leaving the crystal
+            if (post->GetStepStatus() == fGeomBoundary) {
+                fLastInteraction = pre->GetPosition();
+                fExitEnergy = post->GetKineticEnergy();
+                fExitDir = post->GetMomentumDirection();
+            } else {
+                fLastInteraction = post->GetPosition();
+            }
+        }
+    }
+
     G4double edep = step->GetTotalEnergyDeposit();
     if (edep == 0.) return false;
     
+    // First interaction of the event (earliest deposit, whatever the track)
+    G4double time = step->GetPostStepPoint()->GetGlobalTime();
+    if (fTotalEdep == 0. || time < fFirstTime) {
+        fFirstPos = step->GetPostStepPoint()->GetPosition();
+        fFirstTime = time;
+    }
+
     // Accumulate total energy
     fTotalEdep += edep;
+
+    AddHit(edep, step->GetStepLength(), step->GetPostStepPoint()->GetPosition(), time, track->GetTrackID());
+    return true;
+}
+
+void DetectorSD::AddFastDeposit(G4double edep, const G4ThreeVector& pos, G4double time, G4int trackID)
+{
+    if (fTotalEdep == 0. || time < fFirstTime) {
+        fFirstPos = pos;
+        fFirstTime = time;
+    }
+    fTotalEdep += edep;
+
+    AddHit(edep, 0., pos, time, trackID);
+}
+
+void DetectorSD::AddHit(G4double edep, G4double length, const G4ThreeVector& pos, G4double time, G4int trackID)
+{
+    if (!fHitsCollection) return;
+
+    // Merged: the previous hit is that of the same track if any
+    std::size_t nbHits = fHitsCollection->entries();
+    if (fMergeHits && nbHits > 0) {
+        DetectorHit* last = (*fHitsCollection)[nbHits - 1];
+        if (last->GetTrackID() == trackID) {
+            last->Add(edep, length);
+            return;
+        }
+    }
+
+    auto hit = new DetectorHit();
+    hit->SetEdep(edep);
+    hit->SetTrackLength(length);
+    hit->SetPos(pos);
+    hit->SetTime(time);
+    hit->SetTrackID(trackID);
+    fHitsCollection->insert(hit);
+}
+
+G4bool DetectorSD::GetResponse(NaIResponse& response) const
+{
+    if (fNbEntering != 1) return false;
+    response.energy = fEntryEnergy;
+    response.depth = (fLastInteraction - fEntryPos).dot(fEntryDir);
+    response.edep = fTotalEdep;
+    response.exitEnergy = fExitEnergy;
+    response.exitCos = fExitEnergy > 0. ? fExitDir.dot(fEntryDir) : 0.;
     return true;
 }
 
 G4double DetectorSD::GetTotalEnergyWithResolution() const
 {
-  if (fTotalEdep <= 0.) return 0.;
-  
-  // Apply Gaussian energy resolution: σ/E = fEnergyResolution
-  // For NaI, resolution typically follows: σ/E = a/√E + b
-  // Simplified version: constant fractional resolution
-  G4double sigma = fEnergyResolution * fTotalEdep;
-  G4double measuredEnergy = G4RandGauss::shoot(fTotalEdep, sigma);
-  
-  // Ensure non-negative energy
-  return std::max(measuredEnergy, 0.);
+  // Gaussian smearing, sigma/E = a/sqrt(E) + b of this detector.
+  // Offline re-smearing of E1_true/E2_true for other hypotheses: smear.py
+  return ResolutionModel::Smear(fDetectorID, fTotalEdep);
 }
 
 void DetectorSD::Clear() 
 {
     fTotalEdep = 0.;
+    fFirstPos = G4ThreeVector();
+    fFirstTime = 0.;
+    fNbEntering = 0;
+    fEntryTrackID = -1;
+    fEntryEnergy = 0.;
+    fExitEnergy = 0.;
 }
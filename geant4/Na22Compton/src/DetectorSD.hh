@@ -1,28 +1,77 @@
 #pragma once
 
 #include "G4VSensitiveDetector.hh"
+#include "DetectorHit.hh"
 #include "G4Step.hh"
 #include "G4TouchableHistory.hh"
+#include "G4ThreeVector.hh"
 #include "globals.hh"
 
+struct NaIResponse;
+class G4HCofThisEvent;
+
+/// Sensitive detector of a NaI crystal
+///
+/// Scalar sums for the event analysis, and one DetectorHit per step with a
+/// deposit (energy, step length, position, time, track ID) in the "hits"
+/// collection of the event. The hits come from the thread-local pooled
+/// allocator and are released with the collection at the end of the event.
+/// With /detector/mergeHits the steps of a track are merged in one hit
+/// (sums, position and time of its first deposit): the steps of a track
+/// are consecutive, only the last hit is compared.
+
 class DetectorSD : public G4VSensitiveDetector {
 public:
-    DetectorSD(const G4String& name);
+    DetectorSD(const G4String& name, G4int detectorID);
     ~DetectorSD() override = default;
 
+    void Initialize(G4HCofThisEvent* hce) override;
     G4bool ProcessHits(G4Step* step, G4TouchableHistory*) override;
     void Clear();
 
+    // Hits of the current event (null before the first event)
+    DetectorHitsCollection* GetHitsCollection() const { return fHitsCollection; }
+
+    // One hit per track instead of one per step (all the threads, between runs)
+    static void SetMergeHits(G4bool merge) { fMergeHits = merge; }
+
     // Get total energy deposited (raw)
     G4double GetTotalEnergy() const { return fTotalEdep; }
+
+    // First step with an energy deposit in the event
+    G4ThreeVector GetFirstPosition() const { return fFirstPos; }
+    G4double GetFirstTime() const { return fFirstTime; }
     
-    // Get energy with detector resolution applied
+    // Deposit of the fast simulation model (no step)
+    void AddFastDeposit(G4double edep, const G4ThreeVector& pos, G4double time, G4int trackID);
+
+    // Response to the photon entering the crystal (false if none or several)
+    G4bool GetResponse(NaIResponse& response) const;
+
+    // Get energy with detector resolution applied (ResolutionModel)
     G4double GetTotalEnergyWithResolution() const;
-    
-    // Set energy resolution (fractional, e.g., 0.08 for 8%)
-    void SetEnergyResolution(G4double resolution) { fEnergyResolution = resolution; }
+
+    G4int GetDetectorID() const { return fDetectorID; }
 
 private:
+    void AddHit(G4double edep, G4double length, const G4ThreeVector& pos, G4double time, G4int trackID);
+
+    G4int fDetectorID;     // 1 or 2 (resolution parameters)
+    DetectorHitsCollection* fHitsCollection;
+    G4int fHCID;
     G4double fTotalEdep;
-    G4double fEnergyResolution; // Energy resolution parameter
+    G4ThreeVector fFirstPos;
+    G4double fFirstTime;
+
+    // Photon entering the crystal, and leaving it (response table)
+    G4int fNbEntering;
+    G4int fEntryTrackID;
+    G4double fEntryEnergy;
+    G4ThreeVector fEntryPos;
+    G4ThreeVector fEntryDir;
+    G4double fExitEnergy;
+    G4ThreeVector fExitDir;
+    G4ThreeVector fLastInteraction;
+
+    static G4bool fMergeHits;
 };
@@ -1,17 +1,24 @@
-// EventAction.cc - Simplified coincidence detection compatible with existing DetectorSD interface
+// EventAction.cc - Per-thread coincidence detection, counts reported to the RunAction
 #include "EventAction.hh"
 #include "DetectorSD.hh"
+#include "RunAction.hh"
+#include "NaIResponseTable.hh"
 
 #include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4RunManager.hh"
 #include "G4EventManager.hh"
+#include "G4SDManager.hh"
+#include "G4AnalysisManager.hh"
+#include "G4VVisManager.hh"
 #include "G4ios.hh"
 
-EventAction::EventAction(DetectorSD* det1, DetectorSD* det2)
+EventAction::EventAction(RunAction* runAction)
  : G4UserEventAction(),
-   fDet1SD(det1), fDet2SD(det2),
+   fRunAction(runAction),
+   fDet1SD(nullptr), fDet2SD(nullptr),
    fCoincidenceCount(0),
    fTrueCoincidenceCount(0),
    fTotalEvents(0),
@@ -24,6 +31,13 @@ EventAction::~EventAction()
 
 void EventAction::BeginOfEventAction(const G4Event*)
 {
+    // Sensitive detectors of this thread (built by ConstructSDandField)
+    if (!fDet1SD || !fDet2SD) {
+        auto sdManager = G4SDManager::GetSDMpointer();
+        fDet1SD = static_cast<DetectorSD*>(sdManager->FindSensitiveDetector("Det1SD", false));
+        fDet2SD = static_cast<DetectorSD*>(sdManager->FindSensitiveDetector("Det2SD", false));
+    }
+
     // Clear detector energies for new event
     if (fDet1SD) fDet1SD->Clear();
     if (fDet2SD) fDet2SD->Clear();
@@ -32,6 +46,13 @@ void EventAction::BeginOfEventAction(const G4Event*)
 void EventAction::EndOfEventAction(const G4Event* event)
 {
     fTotalEvents++;
+
+    // Full tracking responses of the crystals (/fastsim/recordTable)
+    if (NaIResponseTable::IsRecording()) {
+        NaIResponse response;
+        if (fDet1SD && fDet1SD->GetResponse(response)) NaIResponseTable::Record(response);
+        if (fDet2SD && fDet2SD->GetResponse(response)) NaIResponseTable::Record(response);
+    }
     
     // Get energies from detector SDs (using existing interface)
     G4double det1Energy = fDet1SD ? fDet1SD->GetTotalEnergyWithResolution() : 0.;
@@ -41,9 +62,16 @@ void EventAction::EndOfEventAction(const G4Event* event)
     G4bool det1Hit = (det1Energy > 0.);
     G4bool det2Hit = (det2Energy > 0.);
     
+    // Event weight (biased source), carried by the primary vertices
+    G4double weight = event->GetNumberOfPrimaryVertex() > 0 ? event->GetPrimaryVertex(0)->GetWeight() : 1.;
+
     if (!det1Hit || !det2Hit) {
+        fRunAction->AddEvent(false, false, weight);
+
         // No coincidence - abort visualization
-        G4EventManager::GetEventManager()->AbortCurrentEvent();
+        if (G4VVisManager::GetConcreteInstance()) {
+            G4EventManager::GetEventManager()->AbortCurrentEvent();
+        }
         
         // Clear detector energies for next event
         if (fDet1SD) fDet1SD->Clear();
@@ -64,6 +92,36 @@ void EventAction::EndOfEventAction(const G4Event* event)
     if (isTrueCoincidence) {
         fTrueCoincidenceCount++;
     }
+    fRunAction->AddEvent(true, isTrueCoincidence, weight);
+
+    // Ntuple row and E1 x E2 histogram
+    auto analysisManager = G4AnalysisManager::Instance();
+    G4ThreeVector pos1 = fDet1SD->GetFirstPosition();
+    G4ThreeVector pos2 = fDet2SD->GetFirstPosition();
+    analysisManager->FillNtupleIColumn(0, event->GetEventID());
+    analysisManager->FillNtupleDColumn(1, det1Energy / keV);
+    analysisManager->FillNtupleDColumn(2, det2Energy / keV);
+    analysisManager->FillNtupleDColumn(3, fDet1SD->GetTotalEnergy() / keV);
+    analysisManager->FillNtupleDColumn(4, fDet2SD->GetTotalEnergy() / keV);
+    analysisManager->FillNtupleDColumn(5, pos1.x() / mm);
+    analysisManager->FillNtupleDColumn(6, pos1.y() / mm);
+    analysisManager->FillNtupleDColumn(7, pos1.z() / mm);
+    analysisManager->FillNtupleDColumn(8, fDet1SD->GetFirstTime() / ns);
+    analysisManager->FillNtupleDColumn(9, pos2.x() / mm);
+    analysisManager->FillNtupleDColumn(10, pos2.y() / mm);
+    analysisManager->FillNtupleDColumn(11, pos2.z() / mm);
+    analysisManager->FillNtupleDColumn(12, fDet2SD->GetFirstTime() / ns);
+    analysisManager->FillNtupleDColumn(13, weight);
+    analysisManager->AddNtupleRow();
+    analysisManager->FillH2(0, det1Energy / keV, det2Energy / keV, weight);
+
+    // Interactive session only: print the event and keep its trajectories
+    // for visualization (in batch nothing is kept, memory stays flat)
+    if (!G4VVisManager::GetConcreteInstance()) {
+        if (fDet1SD) fDet1SD->Clear();
+        if (fDet2SD) fDet2SD->Clear();
+        return;
+    }
 
     // Print event information
     G4cout << "=== COINCIDENCE EVENT #" << event->GetEventID() 
@@ -73,6 +131,14 @@ void EventAction::EndOfEventAction(const G4Event* event)
            << (det1_511keV ? " [511keV Peak]" : "") << G4endl;
     G4cout << "Det2 Energy: " << G4BestUnit(det2Energy, "Energy") 
            << (det2_511keV ? " [511keV Peak]" : "") << G4endl;
+
+    // Hits of the event (one per step, or per track with /detector/mergeHits)
+    for (DetectorSD* sd : {fDet1SD, fDet2SD}) {
+        DetectorHitsCollection* hits = sd->GetHitsCollection();
+        if (!hits) continue;
+        G4cout << "Det" << sd->GetDetectorID() << " hits: " << hits->entries() << G4endl;
+        if (G4EventManager::GetEventManager()->GetVerboseLevel() > 0) hits->PrintAllHits();
+    }
     
     if (isTrueCoincidence) {
         G4cout << "*** TRUE ANNIHILATION COINCIDENCE ***" << G4endl;
@@ -92,23 +158,3 @@ G4bool EventAction::IsInEnergyWindow(G4double energy, G4double target, G4double
     G4double upperBound = target * (1.0 + window);
     return (energy >= lowerBound && energy <= upperBound);
 }
-
-void EventAction::PrintStatistics() const
-{
-    G4cout << "\n=== COINCIDENCE STATISTICS ===" << G4endl;
-    G4cout << "Total events processed: " << fTotalEvents << G4endl;
-    G4cout << "Total coincidence events: " << fCoincidenceCount << G4endl;
-    G4cout << "True 511keV coincidences: " << fTrueCoincidenceCount << G4endl;
-    
-    if (fTotalEvents > 0) {
-        G4double coincidenceRate = (G4double)fCoincidenceCount / fTotalEvents * 100.0;
-        G4double trueRate = (G4double)fTrueCoincidenceCount / fTotalEvents * 100.0;
-        G4cout << "Coincidence rate: " << coincidenceRate << "%" << G4endl;
-        G4cout << "True coincidence rate: " << trueRate << "%" << G4endl;
-    }
-    
-    if (fCoincidenceCount > 0) {
-        G4double trueRatio = (G4double)fTrueCoincidenceCount / fCoincidenceCount * 100.0;
-        G4cout << "True/Total coincidence ratio: " << trueRatio << "%" << G4endl;
-    }
-}
@@ -1,4 +1,4 @@
-// EventAction.hh - Simplified header compatible with existing DetectorSD interface
+// EventAction.hh - Per-thread coincidence detection, counts reported to the RunAction
 #ifndef EventAction_h
 #define EventAction_h 1
 
@@ -6,6 +6,7 @@
 #include "globals.hh"
 
 class DetectorSD;
+class RunAction;
 
 /// Enhanced Event action class for coincidence detection
 ///
@@ -13,11 +14,14 @@ class DetectorSD;
 /// - Energy resolution simulation
 /// - Energy window analysis for photopeak identification
 /// - Statistical analysis
+///
+/// One instance per worker thread : the counters are those of the thread,
+/// the RunAction merges them over the threads.
 
 class EventAction : public G4UserEventAction
 {
 public:
-    EventAction(DetectorSD* det1 = nullptr, DetectorSD* det2 = nullptr);
+    EventAction(RunAction* runAction);
     virtual ~EventAction();
     
     virtual void BeginOfEventAction(const G4Event* event);
@@ -32,15 +36,14 @@ public:
     void SetCoincidenceTimeWindow(G4double window) { fCoincidenceTimeWindow = window; }
     void SetEnergyWindow(G4double window) { fEnergyWindow = window; }
     
-    // Analysis methods
-    void PrintStatistics() const;
-    
 private:
-    // Detector references for energy analysis
+    RunAction* fRunAction;
+
+    // Detector references for energy analysis (SDs of this thread)
     DetectorSD* fDet1SD;
     DetectorSD* fDet2SD;
     
-    // Statistics
+    // Statistics of this thread
     G4int fCoincidenceCount;      // Any coincidence (both detectors hit)
     G4int fTrueCoincidenceCount;  // 511keV photopeaks in both detectors
     G4int fTotalEvents;
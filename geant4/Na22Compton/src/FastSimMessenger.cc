@@ -0,0 +1,55 @@
+#include "FastSimMessenger.hh"
+#include "NaIResponseModel.hh"
+#include "NaIResponseTable.hh"
+
+#include "G4UIdirectory.hh"
+
+FastSimMessenger::FastSimMessenger() {
+    fDirectory = new G4UIdirectory("/fastsim/");
+    fDirectory->SetGuidance("Fast simulation of the NaI crystals (response table).");
+
+    // The table is shared by the threads: master only, between runs
+    fRecordTableCmd = new G4UIcmdWithAString("/fastsim/recordTable", this);
+    fRecordTableCmd->SetGuidance("Record the response of the crystals during the next full tracking runs");
+    fRecordTableCmd->SetGuidance("and write them to this file at the end of each run.");
+    fRecordTableCmd->SetParameterName("file", false);
+    fRecordTableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    fRecordTableCmd->SetToBeBroadcasted(false);
+
+    fUseTableCmd = new G4UIcmdWithAString("/fastsim/useTable", this);
+    fUseTableCmd->SetGuidance("Load a response table: photons entering the crystals are not tracked,");
+    fUseTableCmd->SetGuidance("their deposit and scattered photon are sampled from the table.");
+    fUseTableCmd->SetGuidance("Needs the fast simulation physics: ./Na22Compton -f");
+    fUseTableCmd->SetParameterName("file", false);
+    fUseTableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    fUseTableCmd->SetToBeBroadcasted(false);
+
+    fEnableCmd = new G4UIcmdWithABool("/fastsim/enable", this);
+    fEnableCmd->SetGuidance("Use the loaded response table (false: full tracking).");
+    fEnableCmd->SetParameterName("enable", false);
+    fEnableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+    fEnableCmd->SetToBeBroadcasted(false);
+}
+
+FastSimMessenger::~FastSimMessenger() {
+    delete fRecordTableCmd;
+    delete fUseTableCmd;
+    delete fEnableCmd;
+    delete fDirectory;
+}
+
+void FastSimMessenger::SetNewValue(G4UIcommand* command, G4String newValue) {
+    if (command == fRecordTableCmd) {
+        NaIResponseTable::SetRecordFile(newValue);
+    }
+    else if (command == fUseTableCmd) {
+        if (!NaIResponseTable::LoadShared(newValue)) {
+            G4ExceptionDescription msg;
+            msg << "Cannot read the response table " << newValue;
+            command->CommandFailed(msg);
+        }
+    }
+    else if (command == fEnableCmd) {
+        NaIResponseModel::SetEnabled(fEnableCmd->GetNewBoolValue(newValue));
+    }
+}
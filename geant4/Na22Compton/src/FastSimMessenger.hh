@@ -0,0 +1,19 @@
+#pragma once
+
+#include "G4UImessenger.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+
+class FastSimMessenger : public G4UImessenger {
+public:
+    FastSimMessenger();
+    ~FastSimMessenger();
+
+    void SetNewValue(G4UIcommand* command, G4String newValue) override;
+
+private:
+    G4UIdirectory* fDirectory;
+    G4UIcmdWithAString* fRecordTableCmd;
+    G4UIcmdWithAString* fUseTableCmd;
+    G4UIcmdWithABool* fEnableCmd;
+};
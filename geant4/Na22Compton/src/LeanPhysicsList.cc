@@ -0,0 +1,37 @@
+// LeanPhysicsList.cc - EM-only physics list for the 511/1274 keV photons
+#include "LeanPhysicsList.hh"
+
+#include "G4EmStandardPhysics.hh"
+#include "G4EmParameters.hh"
+#include "G4ProductionCuts.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4SystemOfUnits.hh"
+
+LeanPhysicsList::LeanPhysicsList()
+ : G4VModularPhysicsList(),
+   fFineCut(0.1*mm)
+{
+    SetVerboseLevel(0);
+    SetDefaultCutValue(1.*cm);
+
+    // Standard EM everywhere, option 4 models in the crystals and the lead
+    RegisterPhysics(new G4EmStandardPhysics());
+    auto emParameters = G4EmParameters::Instance();
+    emParameters->AddPhysics("NaIRegion", "G4EmStandard_opt4");
+    emParameters->AddPhysics("LeadRegion", "G4EmStandard_opt4");
+}
+
+void LeanPhysicsList::SetCuts()
+{
+    // Coarse default cut (world), fine cuts in the interaction regions
+    // (called on the master, after the geometry and its regions)
+    SetCutsWithDefault();
+    for (const char* name : {"NaIRegion", "LeadRegion"}) {
+        G4Region* region = G4RegionStore::GetInstance()->GetRegion(name, false);
+        if (!region) continue;
+        auto cuts = new G4ProductionCuts();
+        cuts->SetProductionCut(fFineCut);
+        region->SetProductionCuts(cuts);
+    }
+}
@@ -0,0 +1,29 @@
+// LeanPhysicsList.hh - EM-only physics list for the 511/1274 keV photons
+#ifndef LeanPhysicsList_h
+#define LeanPhysicsList_h 1
+
+#include "G4VModularPhysicsList.hh"
+#include "globals.hh"
+
+/// Lean physics list (Na22Compton -p lean)
+///
+/// Electromagnetic physics only: no hadronic or decay processes, the
+/// source emits the photons directly. Standard EM models and a coarse
+/// production cut (1 cm) in the world (air), option 4 models and a fine
+/// cut (0.1 mm) in the regions where the photons interact: the crystals
+/// (NaIRegion) and the lead shield (LeadRegion).
+/// The cuts can be changed with /run/setCut and /run/setCutForRegion.
+
+class LeanPhysicsList : public G4VModularPhysicsList
+{
+public:
+    LeanPhysicsList();
+    ~LeanPhysicsList() override = default;
+
+    void SetCuts() override;
+
+private:
+    G4double fFineCut;
+};
+
+#endif
@@ -0,0 +1,78 @@
+// NaIResponseModel.cc - Fast simulation of the NaI crystals
+#include "NaIResponseModel.hh"
+#include "NaIResponseTable.hh"
+#include "DetectorSD.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4Gamma.hh"
+#include "G4DynamicParticle.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VSolid.hh"
+#include "G4AffineTransform.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+
+G4bool NaIResponseModel::fEnabled = true;
+
+NaIResponseModel::NaIResponseModel(const G4String& name, G4Region* region)
+ : G4VFastSimulationModel(name, region)
+{}
+
+G4bool NaIResponseModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+    return &particle == G4Gamma::Definition();
+}
+
+G4bool NaIResponseModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+    if (!fEnabled || !NaIResponseTable::GetShared()) return false;
+
+    // Photons entering the crystal only (not the ones leaving it from DoIt)
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    return track->GetCurrentStepNumber() > 0 &&
+           track->GetStep()->GetPostStepPoint()->GetStepStatus() == fGeomBoundary;
+}
+
+void NaIResponseModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    G4double energy = track->GetKineticEnergy();
+    const NaIResponse* response = NaIResponseTable::GetShared()->Sample(energy);
+    fastStep.KillPrimaryTrack();
+    if (!response) return;
+
+    // Response of the nearest energy, scaled to this photon
+    G4double scale = energy / response->energy;
+    G4double edep = response->edep * scale;
+    G4double exitEnergy = response->exitEnergy * scale;
+
+    // Last interaction point, inside the crystal
+    const G4VSolid* solid = fastTrack.GetEnvelopeSolid();
+    G4ThreeVector localPos = fastTrack.GetPrimaryTrackLocalPosition();
+    G4ThreeVector localDir = fastTrack.GetPrimaryTrackLocalDirection();
+    G4double depth = std::min(response->depth, solid->DistanceToOut(localPos, localDir));
+    G4ThreeVector localInteraction = localPos + std::max(depth, 0.) * localDir;
+    const G4AffineTransform* toGlobal = fastTrack.GetInverseAffineTransformation();
+    G4ThreeVector interaction = toGlobal->TransformPoint(localInteraction);
+
+    // Energy deposit, to the sensitive detector of the crystal at the interaction
+    // point (not proposed to the fast step: ProcessHits would count it again)
+    auto sd = dynamic_cast<DetectorSD*>(fastTrack.GetEnvelopeLogicalVolume()->GetSensitiveDetector());
+    if (sd && edep > 0.) sd->AddFastDeposit(edep, interaction, track->GetGlobalTime(), track->GetTrackID());
+
+    // Photon leaving the crystal, placed on its surface
+    if (exitEnergy <= 0.) return;
+    G4double cosTheta = std::max(-1., std::min(1., response->exitCos));
+    G4double sinTheta = std::sqrt(1. - cosTheta * cosTheta);
+    G4double phi = CLHEP::twopi * G4UniformRand();
+    G4ThreeVector localExitDir(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+    localExitDir.rotateUz(localDir);
+    G4ThreeVector localExit = localInteraction + solid->DistanceToOut(localInteraction, localExitDir) * localExitDir;
+
+    fastStep.SetNumberOfSecondaryTracks(1);
+    G4DynamicParticle photon(G4Gamma::Definition(), toGlobal->TransformAxis(localExitDir), exitEnergy);
+    fastStep.CreateSecondaryTrack(photon, toGlobal->TransformPoint(localExit), track->GetGlobalTime(), false);
+}
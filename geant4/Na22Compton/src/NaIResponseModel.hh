@@ -0,0 +1,31 @@
+// NaIResponseModel.hh - Fast simulation of the NaI crystals
+#ifndef NaIResponseModel_h
+#define NaIResponseModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+
+/// Fast simulation model of the NaI crystals (region "NaIRegion")
+///
+/// A photon entering Det1 or Det2 is not tracked in the crystal: a response
+/// of the shared NaIResponseTable gives the energy deposited, added to the
+/// DetectorSD of the crystal, and the photon leaving it (if any).
+/// Inactive while no table is loaded (/fastsim/useTable) or when
+/// /fastsim/enable is false: full tracking stays the validation path.
+
+class NaIResponseModel : public G4VFastSimulationModel
+{
+public:
+    NaIResponseModel(const G4String& name, G4Region* region);
+    ~NaIResponseModel() override = default;
+
+    G4bool IsApplicable(const G4ParticleDefinition& particle) override;
+    G4bool ModelTrigger(const G4FastTrack& fastTrack) override;
+    void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep) override;
+
+    static void SetEnabled(G4bool enabled) { fEnabled = enabled; }
+
+private:
+    static G4bool fEnabled;
+};
+
+#endif
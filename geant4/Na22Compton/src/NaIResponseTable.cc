@@ -0,0 +1,119 @@
+// NaIResponseTable.cc - Response of a NaI crystal to an entering photon
+#include "NaIResponseTable.hh"
+
+#include "G4AutoLock.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    G4Mutex recordMutex = G4MUTEX_INITIALIZER;
+}
+
+NaIResponseTable* NaIResponseTable::fShared = nullptr;
+NaIResponseTable* NaIResponseTable::fRecorded = nullptr;
+G4String NaIResponseTable::fRecordFile;
+
+NaIResponseTable::NaIResponseTable()
+ : fBins(kNbBins), fSize(0)
+{}
+
+void NaIResponseTable::Add(const NaIResponse& response)
+{
+    G4int bin = static_cast<G4int>(response.energy / keV / kBinWidth);
+    if (bin < 0 || bin >= kNbBins) return;
+    fBins[bin].push_back(response);
+    fSize++;
+}
+
+const NaIResponse* NaIResponseTable::Sample(G4double energy) const
+{
+    // Bin of the energy, or the nearest filled one
+    G4int bin = static_cast<G4int>(energy / keV / kBinWidth);
+    if (bin >= kNbBins) bin = kNbBins - 1;
+    for (G4int d = 0; d < kNbBins; ++d) {
+        for (G4int b : {bin - d, bin + d}) {
+            if (b < 0 || b >= kNbBins || fBins[b].empty()) continue;
+            const std::vector<NaIResponse>& responses = fBins[b];
+            std::size_t i = static_cast<std::size_t>(G4UniformRand() * responses.size());
+            return &responses[std::min(i, responses.size() - 1)];
+        }
+    }
+    return nullptr;
+}
+
+void NaIResponseTable::Clear()
+{
+    for (auto& responses : fBins) responses.clear();
+    fSize = 0;
+}
+
+G4bool NaIResponseTable::Read(const G4String& fileName)
+{
+    std::ifstream in(fileName);
+    if (!in) return false;
+    Clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream is(line);
+        NaIResponse r;
+        if (!(is >> r.energy >> r.depth >> r.edep >> r.exitEnergy >> r.exitCos)) continue;
+        r.energy *= keV;
+        r.depth *= mm;
+        r.edep *= keV;
+        r.exitEnergy *= keV;
+        Add(r);
+    }
+    return true;
+}
+
+G4bool NaIResponseTable::Write(const G4String& fileName) const
+{
+    std::ofstream out(fileName);
+    if (!out) return false;
+    out << "# NaI response: energy(keV) depth(mm) edep(keV) exit_energy(keV) exit_cos\n";
+    for (const auto& responses : fBins) {
+        for (const auto& r : responses) {
+            out << r.energy / keV << ' ' << r.depth / mm << ' ' << r.edep / keV << ' '
+                << r.exitEnergy / keV << ' ' << r.exitCos << '\n';
+        }
+    }
+    return static_cast<G4bool>(out);
+}
+
+G4bool NaIResponseTable::LoadShared(const G4String& fileName)
+{
+    auto table = new NaIResponseTable();
+    if (!table->Read(fileName) || table->Size() == 0) {
+        delete table;
+        return false;
+    }
+    delete fShared;
+    fShared = table;
+    G4cout << "NaI response table " << fileName << ": " << fShared->Size() << " responses" << G4endl;
+    return true;
+}
+
+void NaIResponseTable::Record(const NaIResponse& response)
+{
+    G4AutoLock lock(&recordMutex);
+    if (!fRecorded) fRecorded = new NaIResponseTable();
+    fRecorded->Add(response);
+}
+
+void NaIResponseTable::WriteRecorded()
+{
+    G4AutoLock lock(&recordMutex);
+    if (!fRecorded || fRecordFile.empty()) return;
+    if (fRecorded->Write(fRecordFile)) {
+        G4cout << "NaI response table " << fRecordFile << ": " << fRecorded->Size() << " responses" << G4endl;
+    }
+    else {
+        G4cerr << "Cannot write " << fRecordFile << G4endl;
+    }
+}
@@ -0,0 +1,61 @@
+// NaIResponseTable.hh - Response of a NaI crystal to an entering photon
+#ifndef NaIResponseTable_h
+#define NaIResponseTable_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+/// One photon entering a crystal, from full simulation
+struct NaIResponse {
+    G4double energy;     // incident energy
+    G4double depth;      // depth of the last interaction along the incident direction
+    G4double edep;       // energy deposited in the crystal
+    G4double exitEnergy; // energy of the photon leaving the crystal (0 if absorbed)
+    G4double exitCos;    // cosine between the leaving and incident directions
+};
+
+/// Response table
+///
+/// Responses recorded with full tracking (/fastsim/recordTable), binned by
+/// incident energy and stored in a text file; the fast model samples a
+/// response of the bin of the photon energy, scaled to that energy.
+/// The shared table is loaded and the recorded one written by the master,
+/// between runs; the workers read the first and fill the second.
+
+class NaIResponseTable
+{
+public:
+    NaIResponseTable();
+
+    void Add(const NaIResponse& response);
+    const NaIResponse* Sample(G4double energy) const;
+    std::size_t Size() const { return fSize; }
+    void Clear();
+
+    G4bool Read(const G4String& fileName);
+    G4bool Write(const G4String& fileName) const;
+
+    // Table used by the fast model (null: full tracking)
+    static const NaIResponseTable* GetShared() { return fShared; }
+    static G4bool LoadShared(const G4String& fileName);
+
+    // Recording of the responses during full tracking runs
+    static void SetRecordFile(const G4String& fileName) { fRecordFile = fileName; }
+    static G4bool IsRecording() { return !fRecordFile.empty(); }
+    static void Record(const NaIResponse& response);
+    static void WriteRecorded();
+
+private:
+    static constexpr G4double kBinWidth = 10.;  // keV
+    static constexpr G4int kNbBins = 200;       // up to 2 MeV
+
+    std::vector<std::vector<NaIResponse>> fBins;
+    std::size_t fSize;
+
+    static NaIResponseTable* fShared;
+    static NaIResponseTable* fRecorded;
+    static G4String fRecordFile;
+};
+
+#endif
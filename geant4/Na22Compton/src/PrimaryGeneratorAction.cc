@@ -1,5 +1,6 @@
 // PrimaryGeneratorAction.cc - Na-22 Source Implementation
 #include "PrimaryGeneratorAction.hh"
+#include "PrimaryGeneratorMessenger.hh"
 
 #include "G4LogicalVolumeStore.hh"
 #include "G4LogicalVolume.hh"
@@ -8,14 +9,36 @@
 #include "G4ParticleGun.hh"
 #include "G4ParticleTable.hh"
 #include "G4ParticleDefinition.hh"
+#include "G4PrimaryVertex.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4Gamma.hh"
+#include "G4Threading.hh"
 #include "Randomize.hh"
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
+
+namespace {
+  // A particle of the decay; partner: other photon of an annihilation
+  struct Primary {
+    G4ParticleDefinition* particle;
+    G4double energy;
+    G4ThreeVector position;
+    G4ThreeVector direction;
+    G4int partner;
+  };
+}
 
 PrimaryGeneratorAction::PrimaryGeneratorAction()
 : G4VUserPrimaryGeneratorAction(),
-  fParticleGun(0)
+  fParticleGun(0),
+  fMessenger(nullptr),
+  fBiasCone(false),
+  fConeAngle(45.*deg),  // covers Det1 seen from the source
+  fDecayTable(),
+  fPositronRange(0.),
+  fAcollinearity(0.)
 {
   G4int n_particle = 1;
   fParticleGun = new G4ParticleGun(n_particle);
@@ -26,13 +49,32 @@ PrimaryGeneratorAction::PrimaryGeneratorAction()
   G4ParticleDefinition* particle = particleTable->FindParticle(particleName="gamma");
   fParticleGun->SetParticleDefinition(particle);
   fParticleGun->SetParticleEnergy(511.*keV);
+
+  fMessenger = new PrimaryGeneratorMessenger(this);
 }
 
 PrimaryGeneratorAction::~PrimaryGeneratorAction()
 {
+  delete fMessenger;
   delete fParticleGun;
 }
 
+void PrimaryGeneratorAction::SetConeAngle(G4double angle)
+{
+  // beyond 90 deg the cones of the two annihilation photons would overlap
+  fConeAngle = std::min(angle, 90.*deg);
+}
+
+G4bool PrimaryGeneratorAction::LoadDecayTable(const G4String& fileName)
+{
+  // On error the current table is kept
+  if (!fDecayTable.Read(fileName)) return false;
+
+  // One generator per thread: printed once
+  if (G4Threading::G4GetThreadId() <= 0) fDecayTable.Print();
+  return true;
+}
+
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 {
   // Na-22 source position (from DetectorConstruction)
@@ -46,56 +88,86 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
   G4ThreeVector randomOffset(r*std::cos(phi), r*std::sin(phi), z);
   G4ThreeVector actualPos = sourcePos + randomOffset;
   
-  // Na-22 decay branching ratios:
-  // 90.3% beta+ -> positron annihilation -> 2 × 511 keV back-to-back
-  // 9.7% electron capture -> 1274 keV gamma
-  
-  G4double rand = G4UniformRand();
-  
-  if (rand < 0.903) {
-    // Positron annihilation: Generate back-to-back 511 keV photons
-    GenerateAnnihilationPhotons(actualPos, anEvent);
-  } else {
-    // Electron capture: Generate 1274 keV photon
-    Generate1274keVPhoton(actualPos, anEvent);
+  // Decay channel (alias sampling, O(1)) and its particles, isotropic.
+  // Na-22: beta+ or EC to the 1274.5 keV level, the 1274.5 keV gamma
+  // comes with the annihilation photons of the beta+ decays
+  std::vector<Primary> primaries;
+  for (const SourceProduct& product : fDecayTable.Sample()) {
+    if (product.particle) {
+      primaries.push_back({product.particle, product.energy, actualPos, SampleIsotropic(), -1});
+      continue;
+    }
+    G4ThreeVector annihilationPos = actualPos + SamplePositronRange();
+    G4ThreeVector dir = SampleIsotropic();
+    G4int first = static_cast<G4int>(primaries.size());
+    primaries.push_back({G4Gamma::Definition(), 511.*keV, annihilationPos, dir, first + 1});
+    primaries.push_back({G4Gamma::Definition(), 511.*keV, annihilationPos, PartnerDirection(dir), first});
+  }
+  if (primaries.empty()) return;
+
+  // Biased cone: one particle forced in the cone (its annihilation partner
+  // follows). Mixture of the N choices: weight N f / k, k particles in the cone
+  G4double weight = 1.;
+  if (fBiasCone) {
+    G4int n = static_cast<G4int>(primaries.size());
+    Primary& forced = primaries[std::min(static_cast<G4int>(G4UniformRand() * n), n - 1)];
+    forced.direction = SampleInCone();
+    if (forced.partner >= 0) primaries[forced.partner].direction = PartnerDirection(forced.direction);
+
+    G4double cosCone = std::cos(fConeAngle);
+    G4int inCone = 0;
+    for (const Primary& primary : primaries) {
+      if (primary.direction.x() >= cosCone) inCone++;
+    }
+    G4double coneFraction = (1. - cosCone) / 2.;
+    weight = n * coneFraction / std::max(inCone, 1);
+  }
+
+  // One vertex per particle, the weight is carried by the vertices (and the tracks)
+  for (const Primary& primary : primaries) {
+    fParticleGun->SetParticleDefinition(primary.particle);
+    fParticleGun->SetParticlePosition(primary.position);
+    fParticleGun->SetParticleMomentumDirection(primary.direction);
+    fParticleGun->SetParticleEnergy(primary.energy);
+    fParticleGun->GeneratePrimaryVertex(anEvent);
+  }
+  for (G4int i = 0; i < anEvent->GetNumberOfPrimaryVertex(); ++i) {
+    anEvent->GetPrimaryVertex(i)->SetWeight(weight);
   }
 }
 
-void PrimaryGeneratorAction::GenerateAnnihilationPhotons(const G4ThreeVector& pos, G4Event* anEvent)
+G4ThreeVector PrimaryGeneratorAction::SampleIsotropic() const
 {
-  // Generate isotropic direction for first photon
   G4double cosTheta = 2*G4UniformRand() - 1;
   G4double sinTheta = std::sqrt(1 - cosTheta*cosTheta);
   G4double phi = 2*M_PI * G4UniformRand();
-  
-  G4ThreeVector dir1(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
-  G4ThreeVector dir2 = -dir1; // Back-to-back
-  
-  // First photon
-  fParticleGun->SetParticlePosition(pos);
-  fParticleGun->SetParticleMomentumDirection(dir1);
-  fParticleGun->SetParticleEnergy(511.*keV);
-  fParticleGun->GeneratePrimaryVertex(anEvent);
-  
-  // Second photon (back-to-back)
-  fParticleGun->SetParticlePosition(pos);
-  fParticleGun->SetParticleMomentumDirection(dir2);
-  fParticleGun->SetParticleEnergy(511.*keV);
-  fParticleGun->GeneratePrimaryVertex(anEvent);
+  return G4ThreeVector(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
 }
 
-void PrimaryGeneratorAction::Generate1274keVPhoton(const G4ThreeVector& pos, G4Event* anEvent)
+G4ThreeVector PrimaryGeneratorAction::SampleInCone() const
 {
-  // Generate isotropic direction
-  G4double cosTheta = 2*G4UniformRand() - 1;
+  // Uniform in the cone around +x
+  G4double cosTheta = 1. - (1. - std::cos(fConeAngle)) * G4UniformRand();
   G4double sinTheta = std::sqrt(1 - cosTheta*cosTheta);
   G4double phi = 2*M_PI * G4UniformRand();
-  
-  G4ThreeVector dir(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
-  
-  // Single 1274 keV photon
-  fParticleGun->SetParticlePosition(pos);
-  fParticleGun->SetParticleMomentumDirection(dir);
-  fParticleGun->SetParticleEnergy(1274.*keV);
-  fParticleGun->GeneratePrimaryVertex(anEvent);
+  return G4ThreeVector(cosTheta, sinTheta*std::cos(phi), sinTheta*std::sin(phi));
+}
+
+G4ThreeVector PrimaryGeneratorAction::SamplePositronRange() const
+{
+  // Exponential distance, isotropic (the positron slows down in the source)
+  if (fPositronRange <= 0.) return G4ThreeVector();
+  return -fPositronRange * std::log(1. - G4UniformRand()) * SampleIsotropic();
+}
+
+G4ThreeVector PrimaryGeneratorAction::PartnerDirection(const G4ThreeVector& dir) const
+{
+  // Back-to-back, deviated by a 2D Gaussian angle (residual momentum of the pair)
+  G4ThreeVector partner = -dir;
+  if (fAcollinearity <= 0.) return partner;
+  G4double sigma = fAcollinearity / (2. * std::sqrt(2. * std::log(2.)));
+  G4double theta = sigma * std::sqrt(-2. * std::log(1. - G4UniformRand()));
+  G4ThreeVector axis = dir.orthogonal().unit();
+  axis.rotate(2*M_PI * G4UniformRand(), dir);
+  return partner.rotate(theta, axis);
 }
@@ -5,15 +5,27 @@
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "G4ParticleGun.hh"
 #include "globals.hh"
+#include "SourceDecayTable.hh"
 
 class G4ParticleGun;
 class G4Event;
+class PrimaryGeneratorMessenger;
 
 /// The primary generator action class with particle gun.
 ///
 /// The default kinematic is a gamma ray with 511 keV energy, 
 /// randomly distributed in front of the phantom across 80% of the 
 /// transverse (X,Y) phantom size.
+///
+/// Na-22 source: the decay channel is drawn from a SourceDecayTable
+/// (/source/decayTable), the annihilation photons come from the end of an
+/// optional positron range and are optionally acollinear.
+///
+/// Optional variance reduction (/source/biasCone): one particle of the
+/// decay, chosen at random, is emitted in a cone around +x (slit and Det1).
+/// The primary vertices carry the weight N f / k (N particles, f solid
+/// angle fraction of the cone, k particles in the cone), exact for any
+/// final state.
 
 class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 {
@@ -27,12 +39,31 @@ public:
   // method to access particle gun
   const G4ParticleGun* GetParticleGun() const { return fParticleGun; }
 
+  // biased emission cone
+  void SetBiasCone(G4bool bias) { fBiasCone = bias; }
+  void SetConeAngle(G4double angle);
+
+  // decay channels, positron range and acollinearity
+  G4bool LoadDecayTable(const G4String& fileName);
+  void SetPositronRange(G4double range) { fPositronRange = range; }
+  void SetAcollinearity(G4double fwhm) { fAcollinearity = fwhm; }
+
 private:
   G4ParticleGun* fParticleGun; // pointer a to G4 gun class
-  
+  PrimaryGeneratorMessenger* fMessenger;
+
+  G4bool fBiasCone;     // emission in the cone around +x
+  G4double fConeAngle;  // half angle of the cone
+
+  SourceDecayTable fDecayTable;
+  G4double fPositronRange;  // mean distance to the annihilation (0: none)
+  G4double fAcollinearity;  // FWHM of the deviation from 180 deg (0: none)
+
   // Helper methods for Na-22 decay simulation
-  void GenerateAnnihilationPhotons(const G4ThreeVector& pos, G4Event* anEvent);
-  void Generate1274keVPhoton(const G4ThreeVector& pos, G4Event* anEvent);
+  G4ThreeVector SampleIsotropic() const;
+  G4ThreeVector SampleInCone() const;
+  G4ThreeVector SamplePositronRange() const;
+  G4ThreeVector PartnerDirection(const G4ThreeVector& dir) const;
 };
 
 #endif
@@ -0,0 +1,70 @@
+#include "PrimaryGeneratorMessenger.hh"
+#include "PrimaryGeneratorAction.hh"
+
+PrimaryGeneratorMessenger::PrimaryGeneratorMessenger(PrimaryGeneratorAction* gun)
+ : fGun(gun) {
+    fBiasConeCmd = new G4UIcmdWithABool("/source/biasCone", this);
+    fBiasConeCmd->SetGuidance("Emit one photon in a cone around +x (toward the slit and Det1),");
+    fBiasConeCmd->SetGuidance("the event weight being the probability of the cone.");
+    fBiasConeCmd->SetParameterName("bias", false);
+    fBiasConeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fConeAngleCmd = new G4UIcmdWithADoubleAndUnit("/source/coneAngle", this);
+    fConeAngleCmd->SetGuidance("Half angle of the biased emission cone.");
+    fConeAngleCmd->SetParameterName("angle", false);
+    fConeAngleCmd->SetUnitCategory("Angle");
+    fConeAngleCmd->SetRange("angle > 0.");
+    fConeAngleCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fDecayTableCmd = new G4UIcmdWithAString("/source/decayTable", this);
+    fDecayTableCmd->SetGuidance("Read the decay channels of the source, one per line:");
+    fDecayTableCmd->SetGuidance("  probability product [product ...]");
+    fDecayTableCmd->SetGuidance("product: annihilation (two 511 keV photons) or particle:energy_keV.");
+    fDecayTableCmd->SetGuidance("Default: Na-22 (see na22_decay.dat).");
+    fDecayTableCmd->SetParameterName("file", false);
+    fDecayTableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fPositronRangeCmd = new G4UIcmdWithADoubleAndUnit("/source/positronRange", this);
+    fPositronRangeCmd->SetGuidance("Mean distance from the decay to the annihilation (exponential, 0: none).");
+    fPositronRangeCmd->SetParameterName("range", false);
+    fPositronRangeCmd->SetUnitCategory("Length");
+    fPositronRangeCmd->SetRange("range >= 0.");
+    fPositronRangeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fAcollinearityCmd = new G4UIcmdWithADoubleAndUnit("/source/acollinearity", this);
+    fAcollinearityCmd->SetGuidance("FWHM of the deviation of the annihilation photons from 180 deg (0: none).");
+    fAcollinearityCmd->SetParameterName("fwhm", false);
+    fAcollinearityCmd->SetUnitCategory("Angle");
+    fAcollinearityCmd->SetRange("fwhm >= 0.");
+    fAcollinearityCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+PrimaryGeneratorMessenger::~PrimaryGeneratorMessenger() {
+    delete fBiasConeCmd;
+    delete fConeAngleCmd;
+    delete fDecayTableCmd;
+    delete fPositronRangeCmd;
+    delete fAcollinearityCmd;
+}
+
+void PrimaryGeneratorMessenger::SetNewValue(G4UIcommand* command, G4String newValue) {
+    if (command == fBiasConeCmd) {
+        fGun->SetBiasCone(fBiasConeCmd->GetNewBoolValue(newValue));
+    }
+    else if (command == fConeAngleCmd) {
+        fGun->SetConeAngle(fConeAngleCmd->GetNewDoubleValue(newValue));
+    }
+    else if (command == fDecayTableCmd) {
+        if (!fGun->LoadDecayTable(newValue)) {
+            G4ExceptionDescription msg;
+            msg << "Cannot read the decay table " << newValue;
+            command->CommandFailed(msg);
+        }
+    }
+    else if (command == fPositronRangeCmd) {
+        fGun->SetPositronRange(fPositronRangeCmd->GetNewDoubleValue(newValue));
+    }
+    else if (command == fAcollinearityCmd) {
+        fGun->SetAcollinearity(fAcollinearityCmd->GetNewDoubleValue(newValue));
+    }
+}
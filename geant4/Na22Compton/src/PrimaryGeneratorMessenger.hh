@@ -0,0 +1,24 @@
+#pragma once
+
+#include "G4UImessenger.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAString.hh"
+
+class PrimaryGeneratorAction;
+
+class PrimaryGeneratorMessenger : public G4UImessenger {
+public:
+    PrimaryGeneratorMessenger(PrimaryGeneratorAction* gun);
+    ~PrimaryGeneratorMessenger();
+
+    void SetNewValue(G4UIcommand* command, G4String newValue) override;
+
+private:
+    PrimaryGeneratorAction* fGun;
+    G4UIcmdWithABool* fBiasConeCmd;
+    G4UIcmdWithADoubleAndUnit* fConeAngleCmd;
+    G4UIcmdWithAString* fDecayTableCmd;
+    G4UIcmdWithADoubleAndUnit* fPositronRangeCmd;
+    G4UIcmdWithADoubleAndUnit* fAcollinearityCmd;
+};
@@ -0,0 +1,60 @@
+// ResolutionModel.cc - Energy resolution of the NaI detectors
+#include "ResolutionModel.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+G4double ResolutionModel::fA[kNbDetectors] = {0., 0.};
+G4double ResolutionModel::fB[kNbDetectors] = {0.08, 0.08};
+
+void ResolutionModel::Set(G4int detector, G4double a, G4double b)
+{
+    if (detector < 1 || detector > kNbDetectors) return;
+    fA[detector - 1] = a;
+    fB[detector - 1] = b;
+}
+
+G4bool ResolutionModel::Load(const G4String& fileName)
+{
+    // Lines "detector a b" (sigma/E = a/sqrt(E/keV) + b), '#' comments
+    std::ifstream in(fileName);
+    if (!in) return false;
+    std::string line;
+    G4int nbRead = 0;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream is(line);
+        G4int detector;
+        G4double a, b;
+        if (!(is >> detector >> a >> b)) continue;
+        Set(detector, a, b);
+        nbRead++;
+    }
+    G4cout << "Energy resolution (sigma/E = a/sqrt(E/keV) + b) from " << fileName << ":" << G4endl;
+    for (G4int i = 0; i < kNbDetectors; ++i) {
+        G4cout << "  detector " << i + 1 << ": a = " << fA[i] << ", b = " << fB[i] << G4endl;
+    }
+    return nbRead > 0;
+}
+
+G4double ResolutionModel::Sigma(G4int detector, G4double energy)
+{
+    if (energy <= 0. || detector < 1 || detector > kNbDetectors) return 0.;
+    G4int i = detector - 1;
+    return energy * (fA[i] / std::sqrt(energy / keV) + fB[i]);
+}
+
+G4double ResolutionModel::Smear(G4int detector, G4double energy)
+{
+    if (energy <= 0.) return 0.;
+    G4double measuredEnergy = G4RandGauss::shoot(energy, Sigma(detector, energy));
+
+    // Ensure non-negative energy
+    return std::max(measuredEnergy, 0.);
+}
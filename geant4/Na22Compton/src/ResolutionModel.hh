@@ -0,0 +1,32 @@
+// ResolutionModel.hh - Energy resolution of the NaI detectors
+#ifndef ResolutionModel_h
+#define ResolutionModel_h 1
+
+#include "globals.hh"
+
+/// Energy resolution
+///
+/// NaI resolution: sigma/E = a/sqrt(E/keV) + b, one (a, b) per detector.
+/// The parameters come from the peak widths fitted by
+/// Calibration/calibration.py (resolution.txt) or from /detector/resolution.
+/// They are shared by the threads, set by the master between runs.
+/// The default (a = 0, b = 8%) is the former constant resolution.
+
+class ResolutionModel
+{
+public:
+    static void Set(G4int detector, G4double a, G4double b);
+    static G4bool Load(const G4String& fileName);
+
+    // Resolution (sigma) and smeared energy of a deposit in a detector (1 or 2)
+    static G4double Sigma(G4int detector, G4double energy);
+    static G4double Smear(G4int detector, G4double energy);
+
+private:
+    static constexpr G4int kNbDetectors = 2;
+
+    static G4double fA[kNbDetectors];
+    static G4double fB[kNbDetectors];
+};
+
+#endif
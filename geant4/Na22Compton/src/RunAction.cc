@@ -0,0 +1,133 @@
+// RunAction.cc - Coincidence statistics merged over the worker threads
+#include "RunAction.hh"
+#include "NaIResponseTable.hh"
+
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4AccumulableManager.hh"
+#include "G4AnalysisManager.hh"
+#include "G4ios.hh"
+
+#include <cmath>
+
+RunAction::RunAction()
+ : G4UserRunAction()
+{
+    auto accumulableManager = G4AccumulableManager::Instance();
+    accumulableManager->RegisterAccumulable(fTotalEvents);
+    accumulableManager->RegisterAccumulable(fCoincidenceCount);
+    accumulableManager->RegisterAccumulable(fTrueCoincidenceCount);
+    accumulableManager->RegisterAccumulable(fCoincidenceWeight);
+    accumulableManager->RegisterAccumulable(fCoincidenceWeight2);
+    accumulableManager->RegisterAccumulable(fTrueCoincidenceWeight);
+    accumulableManager->RegisterAccumulable(fTrueCoincidenceWeight2);
+
+    // Per-event output (one instance per thread, merged into one file)
+    // default file Na22Compton.root, see /analysis/setFileName
+    auto analysisManager = G4AnalysisManager::Instance();
+    analysisManager->SetDefaultFileType("root");
+    analysisManager->SetFileName("Na22Compton");
+    analysisManager->SetNtupleMerging(true);
+    analysisManager->SetVerboseLevel(0);
+
+    // E1 x E2 with the binning of the measured histograms (compton.py)
+    analysisManager->CreateH2("coinc", "Detector1 - Detector2;E1 (keV);E2 (keV)",
+                              200, 0., 2000., 200, 0., 2000.);
+
+    // Coincidence events: energies in keV, positions in mm, times in ns
+    analysisManager->CreateNtuple("events", "Coincidence events");
+    analysisManager->CreateNtupleIColumn("eventID");
+    analysisManager->CreateNtupleDColumn("E1");
+    analysisManager->CreateNtupleDColumn("E2");
+    analysisManager->CreateNtupleDColumn("E1_true");
+    analysisManager->CreateNtupleDColumn("E2_true");
+    analysisManager->CreateNtupleDColumn("x1");
+    analysisManager->CreateNtupleDColumn("y1");
+    analysisManager->CreateNtupleDColumn("z1");
+    analysisManager->CreateNtupleDColumn("t1");
+    analysisManager->CreateNtupleDColumn("x2");
+    analysisManager->CreateNtupleDColumn("y2");
+    analysisManager->CreateNtupleDColumn("z2");
+    analysisManager->CreateNtupleDColumn("t2");
+    analysisManager->CreateNtupleDColumn("weight");
+    analysisManager->FinishNtuple();
+}
+
+void RunAction::BeginOfRunAction(const G4Run*)
+{
+    // Reset the counters of this thread
+    G4AccumulableManager::Instance()->Reset();
+
+    G4AnalysisManager::Instance()->OpenFile();
+    if (IsMaster()) fTimer.Start();
+}
+
+void RunAction::EndOfRunAction(const G4Run* run)
+{
+    // Output flushed and closed (merged on the master)
+    auto analysisManager = G4AnalysisManager::Instance();
+    analysisManager->Write();
+    analysisManager->CloseFile();
+
+    if (run->GetNumberOfEvent() == 0) return;
+
+    // Worker counts are added to the master ones
+    G4AccumulableManager::Instance()->Merge();
+
+    if (IsMaster()) {
+        fTimer.Stop();
+        G4cout << "Run time: " << fTimer.GetRealElapsed() << " s, "
+               << run->GetNumberOfEvent() / fTimer.GetRealElapsed() << " events/s" << G4endl;
+        PrintStatistics();
+        if (NaIResponseTable::IsRecording()) NaIResponseTable::WriteRecorded();
+    }
+}
+
+void RunAction::AddEvent(G4bool coincidence, G4bool trueCoincidence, G4double weight)
+{
+    fTotalEvents += 1;
+    if (coincidence) {
+        fCoincidenceCount += 1;
+        fCoincidenceWeight += weight;
+        fCoincidenceWeight2 += weight * weight;
+    }
+    if (trueCoincidence) {
+        fTrueCoincidenceCount += 1;
+        fTrueCoincidenceWeight += weight;
+        fTrueCoincidenceWeight2 += weight * weight;
+    }
+}
+
+void RunAction::PrintStatistics() const
+{
+    G4int totalEvents = fTotalEvents.GetValue();
+    G4int coincidenceCount = fCoincidenceCount.GetValue();
+    G4int trueCoincidenceCount = fTrueCoincidenceCount.GetValue();
+
+    G4cout << "\n=== COINCIDENCE STATISTICS ===" << G4endl;
+    G4cout << "Total events processed: " << totalEvents << G4endl;
+    G4cout << "Total coincidence events: " << coincidenceCount << G4endl;
+    G4cout << "True 511keV coincidences: " << trueCoincidenceCount << G4endl;
+
+    if (totalEvents > 0) {
+        G4double coincidenceRate = (G4double)coincidenceCount / totalEvents * 100.0;
+        G4double trueRate = (G4double)trueCoincidenceCount / totalEvents * 100.0;
+        G4cout << "Coincidence rate: " << coincidenceRate << "%" << G4endl;
+        G4cout << "True coincidence rate: " << trueRate << "%" << G4endl;
+    }
+
+    if (coincidenceCount > 0) {
+        G4double trueRatio = (G4double)trueCoincidenceCount / coincidenceCount * 100.0;
+        G4cout << "True/Total coincidence ratio: " << trueRatio << "%" << G4endl;
+    }
+
+    // Per decay, comparable between biased and unbiased runs
+    if (totalEvents > 0) {
+        G4cout << "Weighted coincidences per decay: "
+               << fCoincidenceWeight.GetValue() / totalEvents << " +- "
+               << std::sqrt(fCoincidenceWeight2.GetValue()) / totalEvents << G4endl;
+        G4cout << "Weighted true coincidences per decay: "
+               << fTrueCoincidenceWeight.GetValue() / totalEvents << " +- "
+               << std::sqrt(fTrueCoincidenceWeight2.GetValue()) / totalEvents << G4endl;
+    }
+}
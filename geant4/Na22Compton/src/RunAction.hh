@@ -0,0 +1,49 @@
+// RunAction.hh - Coincidence statistics merged over the worker threads
+#ifndef RunAction_h
+#define RunAction_h 1
+
+#include "G4UserRunAction.hh"
+#include "G4Accumulable.hh"
+#include "G4Timer.hh"
+#include "globals.hh"
+
+class G4Run;
+
+/// Run action class
+///
+/// Each worker thread counts its events in accumulables which are merged
+/// into the master ones at the end of the run; the master prints the
+/// statistics of the whole run.
+/// The coincidence events are written to the "events" ntuple and the
+/// "coinc" E1 x E2 histogram of the analysis file.
+
+class RunAction : public G4UserRunAction
+{
+public:
+    RunAction();
+    ~RunAction() override = default;
+
+    void BeginOfRunAction(const G4Run* run) override;
+    void EndOfRunAction(const G4Run* run) override;
+
+    // Called by the EventAction of the same thread
+    void AddEvent(G4bool coincidence, G4bool trueCoincidence, G4double weight = 1.);
+
+private:
+    G4Accumulable<G4int> fTotalEvents = 0;
+    G4Accumulable<G4int> fCoincidenceCount = 0;      // Any coincidence (both detectors hit)
+    G4Accumulable<G4int> fTrueCoincidenceCount = 0;  // 511keV photopeaks in both detectors
+
+    // Weighted counts (biased source) and sums of squared weights for the errors
+    G4Accumulable<G4double> fCoincidenceWeight = 0.;
+    G4Accumulable<G4double> fCoincidenceWeight2 = 0.;
+    G4Accumulable<G4double> fTrueCoincidenceWeight = 0.;
+    G4Accumulable<G4double> fTrueCoincidenceWeight2 = 0.;
+
+    // Event rate of the run (master)
+    G4Timer fTimer;
+
+    void PrintStatistics() const;
+};
+
+#endif
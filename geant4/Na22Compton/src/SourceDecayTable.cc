@@ -0,0 +1,141 @@
+// SourceDecayTable.cc - Decay channels of the source, alias sampling
+#include "SourceDecayTable.hh"
+
+#include "G4ParticleTable.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4Gamma.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+SourceDecayTable::SourceDecayTable()
+{
+    SetNa22();
+}
+
+void SourceDecayTable::SetNa22()
+{
+    // NNDC: the 1274.5 keV gamma follows the beta+ and EC decays to the
+    // excited level, the ground state beta+ branch has no prompt gamma
+    const SourceProduct annihilation = {nullptr, 0.};
+    const SourceProduct gamma1274 = {G4Gamma::Definition(), 1274.537*keV};
+    Clear();
+    AddChannel(0.9030, {annihilation, gamma1274});   // beta+ to 1274.5 keV
+    AddChannel(0.0964, {gamma1274});                 // EC to 1274.5 keV
+    AddChannel(0.00056, {annihilation});             // beta+ to ground state
+}
+
+void SourceDecayTable::AddChannel(G4double probability, const std::vector<SourceProduct>& products)
+{
+    if (probability <= 0.) return;
+    fChannels.push_back(products);
+    fProbability.push_back(probability);
+    BuildAlias();
+}
+
+void SourceDecayTable::Clear()
+{
+    fChannels.clear();
+    fProbability.clear();
+    fKeep.clear();
+    fAlias.clear();
+}
+
+void SourceDecayTable::BuildAlias()
+{
+    std::size_t n = fProbability.size();
+    G4double sum = 0.;
+    for (G4double p : fProbability) sum += p;
+
+    // Scaled probabilities: n p_i, split in small (< 1) and large (>= 1)
+    std::vector<G4double> scaled(n);
+    std::vector<std::size_t> small, large;
+    for (std::size_t i = 0; i < n; ++i) {
+        scaled[i] = n * fProbability[i] / sum;
+        (scaled[i] < 1. ? small : large).push_back(i);
+    }
+
+    // Each small column is filled up by a large one (its alias)
+    fKeep.assign(n, 1.);
+    fAlias.resize(n);
+    for (std::size_t i = 0; i < n; ++i) fAlias[i] = i;
+    while (!small.empty() && !large.empty()) {
+        std::size_t s = small.back(); small.pop_back();
+        std::size_t l = large.back();
+        fKeep[s] = scaled[s];
+        fAlias[s] = l;
+        scaled[l] -= 1. - scaled[s];
+        if (scaled[l] < 1.) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Left over columns (rounding) are full
+}
+
+const std::vector<SourceProduct>& SourceDecayTable::Sample() const
+{
+    // Column drawn uniformly, then the channel or its alias
+    std::size_t n = fChannels.size();
+    G4double u = G4UniformRand() * n;
+    std::size_t i = std::min(static_cast<std::size_t>(u), n - 1);
+    return (u - i < fKeep[i]) ? fChannels[i] : fChannels[fAlias[i]];
+}
+
+G4bool SourceDecayTable::Read(const G4String& fileName)
+{
+    std::ifstream in(fileName);
+    if (!in) return false;
+    G4ParticleTable* particleTable = G4ParticleTable::GetParticleTable();
+    std::vector<std::vector<SourceProduct>> channels;
+    std::vector<G4double> probabilities;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream is(line);
+        G4double probability;
+        if (!(is >> probability) || probability <= 0.) continue;
+        std::vector<SourceProduct> products;
+        std::string word;
+        while (is >> word) {
+            if (word[0] == '#') break;
+            if (word == "annihilation") {
+                products.push_back({nullptr, 0.});
+                continue;
+            }
+            std::size_t colon = word.find(':');
+            if (colon == std::string::npos) return false;
+            G4ParticleDefinition* particle = particleTable->FindParticle(word.substr(0, colon));
+            std::istringstream energy(word.substr(colon + 1));
+            G4double energyKeV;
+            if (!particle || !(energy >> energyKeV)) return false;
+            products.push_back({particle, energyKeV*keV});
+        }
+        channels.push_back(products);
+        probabilities.push_back(probability);
+    }
+    if (channels.empty()) return false;
+
+    Clear();
+    for (std::size_t i = 0; i < channels.size(); ++i) AddChannel(probabilities[i], channels[i]);
+    return true;
+}
+
+void SourceDecayTable::Print() const
+{
+    G4double sum = 0.;
+    for (G4double p : fProbability) sum += p;
+    G4cout << "Source decay channels:" << G4endl;
+    for (std::size_t i = 0; i < fChannels.size(); ++i) {
+        G4cout << "  " << 100. * fProbability[i] / sum << " %:";
+        for (const auto& product : fChannels[i]) {
+            if (!product.particle) G4cout << " annihilation";
+            else G4cout << ' ' << product.particle->GetParticleName() << ':' << product.energy / keV;
+        }
+        G4cout << G4endl;
+    }
+}
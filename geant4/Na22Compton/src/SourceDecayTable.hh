@@ -0,0 +1,52 @@
+// SourceDecayTable.hh - Decay channels of the source, alias sampling
+#ifndef SourceDecayTable_h
+#define SourceDecayTable_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+class G4ParticleDefinition;
+
+/// One particle of a decay channel (isotropic), or an annihilation pair
+struct SourceProduct {
+    G4ParticleDefinition* particle;  // null: annihilation of a positron
+    G4double energy;
+};
+
+/// Decay channels of the source
+///
+/// Text file, one channel per line: "probability product [product ...]",
+/// a product being "annihilation" (two 511 keV photons, positron range
+/// and acollinearity of the generator) or "particle:energy_keV".
+/// The probabilities are normalized; a channel is drawn in O(1) with the
+/// alias method (Vose), whatever the number of channels. '#' starts a
+/// comment. Without a file: Na-22 (beta+ and EC to the 1274.5 keV level,
+/// beta+ to the ground state).
+
+class SourceDecayTable
+{
+public:
+    SourceDecayTable();
+
+    void AddChannel(G4double probability, const std::vector<SourceProduct>& products);
+    void Clear();
+    G4bool Read(const G4String& fileName);
+    void SetNa22();
+
+    const std::vector<SourceProduct>& Sample() const;
+    std::size_t Size() const { return fChannels.size(); }
+    void Print() const;
+
+private:
+    void BuildAlias();
+
+    std::vector<std::vector<SourceProduct>> fChannels;
+    std::vector<G4double> fProbability;  // normalized channel probabilities
+
+    // Alias tables: channel i kept with probability fKeep[i], else fAlias[i]
+    std::vector<G4double> fKeep;
+    std::vector<std::size_t> fAlias;
+};
+
+#endif
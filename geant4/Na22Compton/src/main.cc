@@ -1,32 +1,84 @@
 #include "DetectorConstruction.hh"
 #include "ActionInitialization.hh"
-#include "G4RunManager.hh"
+#include "LeanPhysicsList.hh"
+#include "G4RunManagerFactory.hh"
+#include "G4Threading.hh"
 #include "G4VModularPhysicsList.hh"
 #include "FTFP_BERT.hh"
 #include "G4EmStandardPhysics_option4.hh"
+#include "G4FastSimulationPhysics.hh"
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
 #include "G4UImanager.hh"
+#include "G4Timer.hh"
+
+#include <cstdlib>
+#include <cstring>
 
 int main(int argc, char** argv) {
 
-    // --- Run manager ---
-    auto runManager = new G4RunManager();
+    // --- Command line: [-t N] [-p full|lean] [-f] [-b] [macro] ---
+    //   -t N  : number of threads (default: all the cores)
+    //   -p    : physics list, full (FTFP_BERT + EM option 4, default)
+    //           or lean (EM only, per-region models and cuts)
+    //   -f    : fast simulation of the crystals available (/fastsim/useTable),
+    //           off by default: no fast simulation process on the photons
+    //   -b    : batch mode with batch.mac (no vis, no UI)
+    //   macro : batch mode with this macro
+    G4int nThreads = G4Threading::G4GetNumberOfCores();
+    G4String physics = "full";
+    G4bool batch = false;
+    G4bool fastSim = false;
+    G4String macro;
+    for (G4int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc) nThreads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "-p") == 0 && i + 1 < argc) physics = argv[++i];
+        else if (std::strcmp(argv[i], "-f") == 0) fastSim = true;
+        else if (std::strcmp(argv[i], "-b") == 0) batch = true;
+        else macro = argv[i];
+    }
+    if (!macro.empty()) batch = true;
+    if (batch && macro.empty()) macro = "batch.mac";
+
+    // --- Run manager (tasking / MT / serial, see G4RUN_MANAGER_TYPE) ---
+    auto runManager = G4RunManagerFactory::CreateRunManager(G4RunManagerType::Default);
+    if (nThreads > 0) runManager->SetNumberOfThreads(nThreads);
 
     // --- Detector construction ---
     auto det = new DetectorConstruction();
     runManager->SetUserInitialization(det);
 
     // --- Physics list ---
-    G4VModularPhysicsList* physicsList = new FTFP_BERT();
-    physicsList->RegisterPhysics(new G4EmStandardPhysics_option4());
+    G4VModularPhysicsList* physicsList = nullptr;
+    if (physics == "lean") {
+        physicsList = new LeanPhysicsList();
+    } else {
+        physicsList = new FTFP_BERT();
+        physicsList->ReplacePhysics(new G4EmStandardPhysics_option4());
+    }
+    if (fastSim) {
+        auto fastSimulationPhysics = new G4FastSimulationPhysics();
+        fastSimulationPhysics->ActivateFastSimulation("gamma");  // NaI response model
+        physicsList->RegisterPhysics(fastSimulationPhysics);
+    }
     runManager->SetUserInitialization(physicsList);
 
-    // Initialize - this calls ConstructSDandField()
+    // --- User actions (before initialization, built on each worker) ---
+    runManager->SetUserInitialization(new ActionInitialization());
+
+    // Initialize - the workers call ConstructSDandField()
+    G4Timer initTimer;
+    initTimer.Start();
     runManager->Initialize();
+    initTimer.Stop();
+    G4cout << "Initialization (" << physics << " physics): " << initTimer.GetRealElapsed() << " s" << G4endl;
 
-    // --- User actions (after initialization) ---
-    runManager->SetUserInitialization(new ActionInitialization(det->GetDet1SD(), det->GetDet2SD()));
+    // --- Batch: macro only, no events kept in memory ---
+    if (batch) {
+        G4UImanager::GetUIpointer()->ApplyCommand("/control/execute " + macro);
+        delete runManager;
+        return 0;
+    }
 
     // --- Visualization ---
     auto visManager = new G4VisExecutive();
@@ -21,6 +21,35 @@ echo ""
 echo ""
 
 
+echo "----------------------------------------------------------------------"
+echo "gamma_spectro_parallel"
+echo ""
+./gamma_spectro_parallel /Users/qassem.awayies/Projects/compton-npac/pyfasterac/install/share/fasterac/data/adc_100k.fast 4 5750 6750 500 histo_parallel.xy
+diff histo.xy histo_parallel.xy && echo "same histogram"
+echo ""
+
+
+echo "----------------------------------------------------------------------"
+echo "coinc_rates"
+echo ""
+./coinc_rates /Users/qassem.awayies/Projects/compton-npac/pyfasterac/install/share/fasterac/data/smallgrp.fast 10 1000
+echo ""
+
+
+echo "----------------------------------------------------------------------"
+echo "records_bench"
+echo ""
+./records_bench /Users/qassem.awayies/Projects/compton-npac/pyfasterac/install/share/fasterac/data/adc_100k.fast
+echo ""
+
+
+echo "----------------------------------------------------------------------"
+echo "sort_bench"
+echo ""
+./sort_bench 1000000
+echo ""
+
+
 echo "----------------------------------------------------------------------"
 echo "spectra plot"
 echo ""
@@ -0,0 +1,107 @@
+/*
+ *  Faster file   =>   software coincidences, multiplicities and accidentals
+ *
+ *  The data (groups flattened) are regrouped by the coincidence builder of
+ *  the library (fasterac/fcoinc.h) : a window opens on the oldest free data,
+ *  the data within the window form a coincidence. The delayed windows give
+ *  the accidental coincidence rate.
+ *
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fasterac/fasterac.h"
+#include "fasterac/fcoinc.h"
+
+
+#define MAX_FOLD 16
+
+
+//  Coincidence group : multiplicity count
+
+void on_group (const fcoinc_hit* hits, int nb_hits, void* user) {
+  unsigned long long* folds = (unsigned long long*) user;
+  folds [nb_hits < MAX_FOLD ? nb_hits : MAX_FOLD] += 1;
+}
+
+
+
+
+int main (int argc, char** argv) {
+
+  faster_file_reader_p reader;
+  faster_data_p        data;
+  fcoinc_p             coinc;
+  fcoinc_stats         stats;
+  unsigned long long   folds [MAX_FOLD + 1];
+  unsigned long long   window_ns;
+  unsigned long long   delay_ns = 0;
+  int                  label;
+  long long            offset;
+  int                  n;
+
+  //  Command line usage
+  if (argc < 3) {
+    printf ("\n");
+    printf ("  %s  :  software coincidences of a Faster file.\n", argv [0]);
+    printf ("\n");
+    printf ("  usage : \n");
+    printf ("          %s  input_file.fast  window_ns  [delay_ns]  [label:offset_ns ...]\n", argv[0]);
+    printf ("\n");
+    printf ("         window_ns         : coincidence window\n");
+    printf ("         delay_ns          : delayed window for the accidentals (default : none)\n");
+    printf ("         label:offset_ns   : time offset added to the data of a label\n");
+    printf ("\n");
+    printf ("  example : \n");
+    printf ("          %s  smallgrp.fast  10  1000  4:-3", argv [0]);
+    printf ("\n");
+    printf ("\n");
+    return EXIT_SUCCESS;
+  }
+
+  //  Coincidence builder
+  memset (folds, 0, sizeof (folds));
+  window_ns = strtoull (argv[2], NULL, 10);
+  coinc     = fcoinc_open (window_ns, 2, on_group, folds);
+  if (argc > 3) delay_ns = strtoull (argv[3], NULL, 10);
+  fcoinc_set_delay (coinc, delay_ns);
+  for (n=4; n<argc; n++) {
+    if (sscanf (argv[n], "%d:%lld", &label, &offset) == 2) fcoinc_set_offset (coinc, label, offset);
+  }
+
+  //  Data loop
+  reader = faster_file_reader_open (argv[1]);
+  if (reader == NULL) {
+    printf ("error opening file %s\n", argv[1]);
+    fcoinc_close (coinc);
+    return EXIT_FAILURE;
+  }
+  while ((data = faster_file_reader_next (reader)) != NULL) {
+    if (fcoinc_push (coinc, data) != 0) {
+      printf ("memory error\n");
+      break;
+    }
+  }
+  faster_file_reader_close (reader);
+  fcoinc_flush (coinc);
+  fcoinc_get_stats (coinc, &stats);
+  fcoinc_close (coinc);
+
+  //  Results
+  printf ("  data         : %llu (%llu late)\n", stats.nb_hits, stats.nb_late);
+  printf ("  coincidences : %llu  (%.1f /s)\n", stats.nb_groups, stats.group_rate);
+  for (n=2; n<=MAX_FOLD; n++) {
+    if (folds [n] > 0) printf ("     fold %2d%s   : %llu\n", n, n == MAX_FOLD ? "+" : " ", folds [n]);
+  }
+  if (delay_ns > 0) {
+    printf ("  accidentals  : %llu  (%.1f /s, %.2f %%)\n", stats.nb_accidentals, stats.accidental_rate,
+            stats.nb_groups > 0 ? 100.0 * stats.nb_accidentals / stats.nb_groups : 0.0);
+  }
+
+  return EXIT_SUCCESS;
+
+}
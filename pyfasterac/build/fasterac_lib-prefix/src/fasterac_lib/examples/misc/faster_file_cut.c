@@ -16,6 +16,8 @@ int main (int argc, char** argv) {
   faster_file_reader_p  reader;
   faster_file_writer_p  writer;
   faster_data_p         data;
+  char*                 out_file = "cut.fast";
+  int                   err;
   int                   i;
   int                   n_first;
   int                   n_last;
@@ -36,10 +38,12 @@ int main (int argc, char** argv) {
   }
   n_first = atoi (argv [2]);
   n_last  = atoi (argv [3]);
-  if (argc > 4) {
-    writer = faster_file_writer_open (argv [4]);
-  } else {
-    writer = faster_file_writer_open ("cut.fast");
+  if (argc > 4) out_file = argv [4];
+  writer = faster_file_writer_open (out_file);
+  if (writer == NULL) {
+    printf ("error opening file %s\n", out_file);
+    faster_file_reader_close (reader);
+    return EXIT_FAILURE;
   }
   i = 1;
   while ((i < n_first) && ((data = faster_file_reader_next (reader)) != NULL)) {
@@ -51,6 +55,10 @@ int main (int argc, char** argv) {
     i++;
   }
   faster_file_reader_close (reader);
-  faster_file_writer_close (writer);
+  err = faster_file_writer_close (writer);
+  if (err) {
+    printf ("error writing %s\n", out_file);
+    return err;
+  }
   return EXIT_SUCCESS;
 }
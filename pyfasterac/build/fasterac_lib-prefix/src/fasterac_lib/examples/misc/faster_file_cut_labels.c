@@ -21,6 +21,7 @@ int main (int argc, char** argv) {
   unsigned short        cur_label;
   unsigned short        *labels;
   int                   n_labels;
+  int                   err;
   int                   i;
   int                   ok;
 
@@ -65,7 +66,11 @@ int main (int argc, char** argv) {
 
   free (labels);
   faster_file_reader_close (reader);
-  faster_file_writer_close (writer);
+  err = faster_file_writer_close (writer);
+  if (err) {
+    printf ("error writing %s\n", out_file);
+    return err;
+  }
   return EXIT_SUCCESS;
 
 }
@@ -21,6 +21,7 @@ int main (int argc, char** argv) {
   unsigned short        old_label;
   unsigned short        new_label;
   unsigned short        cur_label;
+  int                   err;
 
   if (argc != 5) {
     printf ("\n");
@@ -57,7 +58,11 @@ int main (int argc, char** argv) {
   }
 
   faster_file_reader_close (reader);
-  faster_file_writer_close (writer);
+  err = faster_file_writer_close (writer);
+  if (err) {
+    printf ("error writing %s\n", out_file);
+    return err;
+  }
   return EXIT_SUCCESS;
 
 }
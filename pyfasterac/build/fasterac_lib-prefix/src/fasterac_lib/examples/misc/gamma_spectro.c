@@ -3,6 +3,9 @@
  *
  *  see also 'spectro_info.c'
  *
+ *  When the file is indexed ('faster_file_index input_file.fast'), only
+ *  the index entries holding data of the selected label and type are read.
+ *
  */
 
 
@@ -14,13 +17,17 @@
 
 #include "fasterac/fasterac.h"
 #include "fasterac/spectro.h"
+#include "fasterac/findex.h"
 
 
 
 
 int main (int argc, char** argv) {
 
-  faster_file_reader_p  reader;
+  faster_file_reader_p  reader  = NULL;
+  findex*               idx     = NULL;
+  findex_reader_p       ireader = NULL;
+  findex_predicate      pred;
   faster_data_p         data;
   unsigned char         alias;
   unsigned short        label;
@@ -36,6 +43,7 @@ int main (int argc, char** argv) {
   FILE*                 specout;
   char                  infilename  [256];
   char                  outfilename [256];
+  char                  idxfilename [1024];
 
   //  Command line usage
   if (argc < 7) {
@@ -73,15 +81,26 @@ int main (int argc, char** argv) {
   histo    = (int*) malloc (sizeof (int) * nb_bins);
   for (bin_idx = 0; bin_idx < nb_bins; bin_idx++) histo [bin_idx] = 0;
 
-  //  Input file reader
-  reader = faster_file_reader_open (infilename);
-  if (reader == NULL) {
+  //  Input file reader (index reader if the file is indexed)
+  findex_filename (infilename, idxfilename);
+  if (findex_read (idxfilename, &idx) == 0 && findex_check (idx, infilename) == 0) {
+    findex_predicate_init  (&pred);
+    findex_predicate_label (&pred, adc_label);
+    findex_predicate_type  (&pred, CRRC4_SPECTRO_TYPE_ALIAS);
+    ireader = findex_reader_open_predicate (infilename, idx, &pred);
+  }
+  if (ireader == NULL) {                                 //  not indexed, or index out of date
+    reader  = faster_file_reader_open (infilename);
+  }
+  if (reader == NULL && ireader == NULL) {
     printf ("error opening file %s\n", infilename);
+    findex_free (idx);
     return EXIT_FAILURE;
   }
 
   //  Loop on data
-  while ((data = faster_file_reader_next (reader)) != NULL) {  //  data reading
+  while ((data = reader != NULL ? faster_file_reader_next (reader)     //  data reading
+                                : findex_reader_next      (ireader)) != NULL) {
     alias = faster_data_type_alias (data);                     //  data type
     label = faster_data_label      (data);                     //  data id
     if (alias==CRRC4_SPECTRO_TYPE_ALIAS && label==adc_label) { //  data selection
@@ -96,7 +115,9 @@ int main (int argc, char** argv) {
   }
 
   //  Reader close
-  faster_file_reader_close (reader);
+  if (reader != NULL) faster_file_reader_close (reader);
+  findex_reader_close (ireader);
+  findex_free (idx);
 
   //  Output file
   specout = fopen (outfilename, "w");
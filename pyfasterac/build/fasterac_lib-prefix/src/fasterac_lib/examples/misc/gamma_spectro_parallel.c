@@ -0,0 +1,143 @@
+/*
+ *  Spectro data in Faster file   =>   Gamma spectrum in ascii file
+ *
+ *  Same as 'gamma_spectro.c', the file being read by all the cores
+ *  (faster_file_parallel_read) : each worker fills its own histogram,
+ *  the histograms are summed at the end.
+ *
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "fasterac/fasterac.h"
+#include "fasterac/spectro.h"
+
+
+
+typedef struct histo_spec {
+  unsigned short  adc_label;
+  double          min;
+  double          max;
+  double          bin_size;
+  int             nb_bins;
+  int*            histo;                          //  merged histogram
+} histo_spec;
+
+typedef struct worker_histo {
+  const histo_spec* spec;
+  int*              histo;
+} worker_histo;
+
+
+//  New worker : empty histogram
+
+void* worker_init (int thread_num, void* user) {
+  worker_histo* w = (worker_histo*) malloc (sizeof (worker_histo));
+  w->spec  = (histo_spec*) user;
+  w->histo = (int*) calloc (w->spec->nb_bins, sizeof (int));
+  return w;
+}
+
+
+//  Data of a worker : same selection as 'gamma_spectro.c'
+
+void worker_data (faster_data_p data, void* context) {
+  worker_histo*     w    = (worker_histo*) context;
+  const histo_spec* spec = w->spec;
+  crrc4_spectro     adc;
+  int               bin_idx;
+  if (faster_data_type_alias (data) == CRRC4_SPECTRO_TYPE_ALIAS && faster_data_label (data) == spec->adc_label) {
+    faster_data_load (data, &adc);
+    if (!adc.saturated && !adc.pileup) {
+      if (adc.measure>=spec->min && adc.measure<=spec->max) {
+        bin_idx = trunc ((adc.measure - spec->min) / spec->bin_size);
+        if (bin_idx == spec->nb_bins) bin_idx--;           //  measure == max
+        w->histo [bin_idx] += 1;
+      }
+    }
+  }
+}
+
+
+//  End of a worker : histogram added to the merged one
+
+void worker_merge (void* context, void* user) {
+  worker_histo* w    = (worker_histo*) context;
+  histo_spec*   spec = (histo_spec*) user;
+  int           bin_idx;
+  for (bin_idx=0; bin_idx<spec->nb_bins; bin_idx++) spec->histo [bin_idx] += w->histo [bin_idx];
+  free (w->histo);
+  free (w);
+}
+
+
+
+
+int main (int argc, char** argv) {
+
+  histo_spec  spec;
+  double      x;
+  int         bin_idx;
+  int         nb_threads = 0;
+  int         err;
+  FILE*       specout;
+
+  //  Command line usage
+  if (argc < 7) {
+    printf ("\n");
+    printf ("  %s  :  histogramming CRRC4 Spectro data from Faster file, on all cores.\n", argv [0]);
+    printf ("\n");
+    printf ("  usage : \n");
+    printf ("          %s  input_file.fast  Spectro_label  min_value  max_value  nb_bins  output_histo.wyw  [nb_threads]\n", argv[0]);
+    printf ("\n");
+    printf ("         input_file.fast               : Faster file (containing crrc4_spectro data)\n");
+    printf ("         Spectro_label                 : CRRC4_spectro data selection\n");
+    printf ("         min_value, max_value, nb_bins : histogram specification\n");
+    printf ("         output_histo.wyw              : output two columns ascii file\n");
+    printf ("         nb_threads                    : worker threads (default : nb of cores)\n");
+    printf ("\n");
+    printf ("  example : \n");
+    printf ("          %s  spectrodata.fast  99  0  40960  4096  ch99_spectrum.txt", argv [0]);
+    printf ("\n");
+    printf ("\n");
+    return EXIT_SUCCESS;
+  }
+
+  //  Argument parsing
+  spec.adc_label = atoi (argv[2]);
+  spec.min       = atof (argv[3]);
+  spec.max       = atof (argv[4]);
+  spec.nb_bins   = atoi (argv[5]);
+  if (argc > 7) nb_threads = atoi (argv[7]);
+
+  //  Histo size, memory allocation and histo reset
+  spec.bin_size = (spec.max - spec.min) / spec.nb_bins;
+  spec.histo    = (int*) calloc (spec.nb_bins, sizeof (int));
+
+  //  Parallel loop on data
+  err = faster_file_parallel_read (argv[1], nb_threads, worker_init, worker_data, worker_merge, &spec);
+  if (err) {
+    printf ("error reading file %s (%d)\n", argv[1], err);
+    return EXIT_FAILURE;
+  }
+
+  //  Output file
+  specout = fopen (argv[6], "w");
+  x = spec.min + spec.bin_size/2;
+  for (bin_idx=0; bin_idx<spec.nb_bins; bin_idx++) {
+    fprintf (specout, "%f %d\n", x, spec.histo [bin_idx]);
+    x += spec.bin_size;
+  }
+  fclose (specout);
+
+  //  Free allocated memory
+  free (spec.histo);
+
+  return EXIT_SUCCESS;
+
+}
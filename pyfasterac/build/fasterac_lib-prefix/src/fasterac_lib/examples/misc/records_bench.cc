@@ -0,0 +1,179 @@
+/*
+ *  Per data cost of the C API and of the C++ record views (fasterac/records.hpp)
+ *
+ *  The file is put in memory, then the CRRC4 spectro and QDC_TDC_X1 data
+ *  (groups flattened) are summed by :
+ *    - the C API : buffer readers, faster_data_* calls, faster_data_load copy,
+ *    - the C API with the group iterators of group.h and faster_data_load_p,
+ *    - fasterac::records<T> (inline accessors, load read in place).
+ *
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "fasterac/records.hpp"
+
+
+struct sums {
+  long long          nb;
+  long long          measure;
+  long long          q1;
+  unsigned long long clock;
+};
+
+
+static double now_s () {
+  struct timespec t;
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+
+//  C API, as in the reader examples
+
+static void c_api_data (faster_data_p data, sums* s) {
+  crrc4_spectro          spectro;
+  qdc_t_x1               qdc;
+  faster_buffer_reader_p group_reader;
+  faster_data_p          group_data;
+  switch (faster_data_type_alias (data)) {
+    case CRRC4_SPECTRO_TYPE_ALIAS:
+      faster_data_load (data, &spectro);
+      s->nb      += 1;
+      s->measure += spectro.measure;
+      s->clock   += faster_data_clock_ns (data) + faster_data_label (data);
+      break;
+    case QDC_TDC_X1_TYPE_ALIAS:
+      faster_data_load (data, &qdc);
+      s->nb    += 1;
+      s->q1    += qdc.q1;
+      s->clock += faster_data_clock_ns (data) + faster_data_label (data);
+      break;
+    case GROUP_TYPE_ALIAS:
+      group_reader = faster_buffer_reader_open (faster_data_load_p (data), faster_data_load_size (data));
+      while ((group_data = faster_buffer_reader_next (group_reader)) != NULL) c_api_data (group_data, s);
+      faster_buffer_reader_close (group_reader);
+      break;
+  }
+}
+
+static sums c_api (const void* space, size_t size) {
+  sums                   s = {0, 0, 0, 0};
+  faster_buffer_reader_p reader = faster_buffer_reader_open (space, size);
+  faster_data_p          data;
+  while ((data = faster_buffer_reader_next (reader)) != NULL) c_api_data (data, &s);
+  faster_buffer_reader_close (reader);
+  return s;
+}
+
+
+//  C API, group iterators and loads in place
+
+static sums c_api_inplace (const void* space, size_t size) {
+  sums                   s = {0, 0, 0, 0};
+  faster_buffer_reader_p reader = faster_buffer_reader_open (space, size);
+  faster_data_p          data;
+  faster_data_p          leaf;
+  group_ungroup          ug;
+  while ((data = faster_buffer_reader_next (reader)) != NULL) {
+    group_ungroup_init (&ug, data);
+    while ((leaf = group_ungroup_next (&ug, NULL)) != NULL) {
+      switch (faster_data_type_alias (leaf)) {
+        case CRRC4_SPECTRO_TYPE_ALIAS:
+          s.nb      += 1;
+          s.measure += ((crrc4_spectro*) faster_data_load_p (leaf))->measure;
+          s.clock   += faster_data_clock_ns (leaf) + faster_data_label (leaf);
+          break;
+        case QDC_TDC_X1_TYPE_ALIAS:
+          s.nb    += 1;
+          s.q1    += ((qdc_t_x1*) faster_data_load_p (leaf))->q1;
+          s.clock += faster_data_clock_ns (leaf) + faster_data_label (leaf);
+          break;
+      }
+    }
+  }
+  faster_buffer_reader_close (reader);
+  return s;
+}
+
+
+//  C++ record views
+
+static sums cxx_records (const void* space, size_t size) {
+  sums s = {0, 0, 0, 0};
+  for (auto r : fasterac::records<> (space, size)) {
+    if (r.is<crrc4_spectro> ()) {
+      fasterac::record_view<crrc4_spectro> spectro (r.data ());
+      s.nb      += 1;
+      s.measure += spectro->measure;
+      s.clock   += r.clock_ns () + r.label ();
+    } else if (r.is<qdc_t_x1> ()) {
+      fasterac::record_view<qdc_t_x1> qdc (r.data ());
+      s.nb    += 1;
+      s.q1    += qdc->q1;
+      s.clock += r.clock_ns () + r.label ();
+    }
+  }
+  return s;
+}
+
+static sums cxx_records_typed (const void* space, size_t size) {
+  sums s = {0, 0, 0, 0};
+  for (auto r : fasterac::records<crrc4_spectro> (space, size)) {
+    s.nb      += 1;
+    s.measure += r->measure;
+    s.clock   += r.clock_ns () + r.label ();
+  }
+  return s;
+}
+
+
+static void run (const char* name, sums (*func) (const void*, size_t), const void* space, size_t size, int repeat) {
+  sums   s    = {0, 0, 0, 0};
+  double best = 1e30;
+  double t;
+  int    n;
+  for (n=0; n<repeat; n++) {
+    t = now_s ();
+    s = func (space, size);
+    t = now_s () - t;
+    if (t < best) best = t;
+  }
+  printf ("  %-28s %10lld data  %8.2f ns/data   (measure %lld  q1 %lld  clock %llu)\n",
+          name, s.nb, s.nb > 0 ? 1e9 * best / s.nb : 0., s.measure, s.q1, s.clock);
+}
+
+
+int main (int argc, char** argv) {
+
+  int repeat = 5;
+
+  if (argc < 2) {
+    printf ("\n");
+    printf ("  %s  :  per data cost of the C API and of the C++ record views.\n", argv [0]);
+    printf ("\n");
+    printf ("  usage : \n");
+    printf ("          %s  input_file.fast  [repeat]\n", argv[0]);
+    printf ("\n");
+    return EXIT_SUCCESS;
+  }
+  if (argc > 2) repeat = atoi (argv [2]);
+
+  fasterac::file_memory file (argv [1]);
+  if (file.error () != 0) {
+    printf ("error loading %s\n", argv [1]);
+    return EXIT_FAILURE;
+  }
+  printf ("  %s : %zu bytes, best of %d\n", argv [1], file.size (), repeat);
+  run ("C API (load copies)",          c_api,             file.data (), file.size (), repeat);
+  run ("C API (group_ungroup)",        c_api_inplace,     file.data (), file.size (), repeat);
+  run ("records<> + record_view<T>",   cxx_records,       file.data (), file.size (), repeat);
+  run ("records<crrc4_spectro>",       cxx_records_typed, file.data (), file.size (), repeat);
+
+  return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,150 @@
+/*
+ *  Sort by clock : qsort versus farray_sort_by_clock (radix sort)
+ *
+ *  NB_DATA synthetic QDC_TDC_X1 data are built in memory with shuffled
+ *  clocks (some equal), then their pointer array is sorted by :
+ *    - qsort with an integer clock comparator,
+ *    - farray_sort_by_clock with 1 thread and with NB_THREADS threads.
+ *  The tdc field holds the position of the data before sorting, the
+ *  comparator breaks ties with it : the three orders must be the same
+ *  (farray_sort_by_clock is stable).
+ *
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fasterac/fasterac.h"
+#include "fasterac/farray.h"
+#include "fasterac/qdc.h"
+
+
+#define DATA_SIZE  (12 + sizeof (qdc_t_x1))
+
+
+double now_s () {
+  struct timespec t;
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+
+int compare_clock_then_tdc (const void* data1, const void* data2) {
+  faster_data_p      d1 = *(faster_data_p*) data1;
+  faster_data_p      d2 = *(faster_data_p*) data2;
+  unsigned long long c1 = faster_data_clock_ns (d1);
+  unsigned long long c2 = faster_data_clock_ns (d2);
+  if (c1 > c2) return  1;
+  if (c1 < c2) return -1;
+  return ((qdc_t_x1*) faster_data_load_p (d1))->tdc - ((qdc_t_x1*) faster_data_load_p (d2))->tdc;
+}
+
+
+int main (int argc, char** argv) {
+
+  long long           nb_data    = 12000000;
+  int                 nb_threads = sysconf (_SC_NPROCESSORS_ONLN);
+  unsigned char*      space;
+  faster_data_p*      shuffled;
+  faster_data_p*      by_qsort;
+  farray              far1;
+  farray              farn;
+  unsigned long long  clock = 0;
+  unsigned long long  word;
+  unsigned short      label = 1;
+  unsigned short      load_size = sizeof (qdc_t_x1);
+  qdc_t_x1            qdc;
+  faster_data_p       tmp;
+  double              t;
+  double              t_qsort;
+  double              t_1;
+  double              t_n;
+  long long           i;
+  long long           j;
+
+  if (argc > 1 && (argv [1][0] < '0' || argv [1][0] > '9')) {
+    printf ("\n");
+    printf ("  %s  :  sort by clock, qsort versus farray_sort_by_clock.\n", argv [0]);
+    printf ("\n");
+    printf ("  usage : \n");
+    printf ("          %s  [nb_data [nb_threads]]     (default %lld data, %d threads)\n", argv [0], nb_data, nb_threads);
+    printf ("\n");
+    return EXIT_SUCCESS;
+  }
+  if (argc > 1) nb_data    = atoll (argv [1]);
+  if (argc > 2) nb_threads = atoi  (argv [2]);
+  if (nb_data < 1 || nb_threads < 1) return EXIT_FAILURE;
+
+  //  data in clock order, then their pointers shuffled
+  space    = (unsigned char*) malloc (nb_data * DATA_SIZE);
+  shuffled = (faster_data_p*) malloc (nb_data * sizeof (faster_data_p));
+  by_qsort = (faster_data_p*) malloc (nb_data * sizeof (faster_data_p));
+  far1.data_array = (faster_data_p*) malloc (nb_data * sizeof (faster_data_p));
+  farn.data_array = (faster_data_p*) malloc (nb_data * sizeof (faster_data_p));
+  if (space == NULL || shuffled == NULL || by_qsort == NULL || far1.data_array == NULL || farn.data_array == NULL) {
+    printf ("error allocating %lld data\n", nb_data);
+    return 2;
+  }
+  srand (1);
+  memset (&qdc, 0, sizeof (qdc));
+  for (i=0; i<nb_data; i++) {
+    clock += 2 * (rand () % 8);                            //  equal clocks now and then
+    word   = ((clock / 2) << 16) | QDC_TDC_X1_TYPE_ALIAS;
+    memcpy (space + i * DATA_SIZE,      &word,      8);
+    memcpy (space + i * DATA_SIZE + 8,  &label,     2);
+    memcpy (space + i * DATA_SIZE + 10, &load_size, 2);
+    shuffled [i] = space + i * DATA_SIZE;
+  }
+  for (i=nb_data-1; i>0; i--) {
+    j            = ((long long) rand () * RAND_MAX + rand ()) % (i + 1);
+    tmp          = shuffled [i];
+    shuffled [i] = shuffled [j];
+    shuffled [j] = tmp;
+  }
+  for (i=0; i<nb_data; i++) {                              //  position before sorting
+    qdc.q1  = i % 1000;
+    qdc.tdc = i;
+    memcpy ((unsigned char*) shuffled [i] + 12, &qdc, sizeof (qdc));
+  }
+  memcpy (by_qsort,        shuffled, nb_data * sizeof (faster_data_p));
+  memcpy (far1.data_array, shuffled, nb_data * sizeof (faster_data_p));
+  memcpy (farn.data_array, shuffled, nb_data * sizeof (faster_data_p));
+  far1.nb_data = nb_data;
+  farn.nb_data = nb_data;
+
+  //  sorts
+  t = now_s ();
+  qsort (by_qsort, nb_data, sizeof (faster_data_p), compare_clock_then_tdc);
+  t_qsort = now_s () - t;
+  t = now_s ();
+  if (farray_sort_by_clock (&far1, 1) != 0) return 2;
+  t_1 = now_s () - t;
+  t = now_s ();
+  if (farray_sort_by_clock (&farn, nb_threads) != 0) return 2;
+  t_n = now_s () - t;
+
+  printf ("  %lld data with shuffled clocks\n", nb_data);
+  printf ("  qsort, clock comparator          %8.3f s\n", t_qsort);
+  printf ("  farray_sort_by_clock, 1 thread   %8.3f s  (%.1fx)\n", t_1, t_qsort / t_1);
+  printf ("  farray_sort_by_clock, %d thread%s  %8.3f s  (%.1fx)\n",
+          nb_threads, nb_threads > 1 ? "s" : " ", t_n, t_qsort / t_n);
+  if (memcmp (by_qsort, far1.data_array, nb_data * sizeof (faster_data_p)) != 0 ||
+      memcmp (by_qsort, farn.data_array, nb_data * sizeof (faster_data_p)) != 0) {
+    printf ("  error : the orders differ\n");
+    return EXIT_FAILURE;
+  }
+  printf ("  same order (stable)\n");
+
+  free (space);
+  free (shuffled);
+  free (by_qsort);
+  free (far1.data_array);
+  free (farn.data_array);
+  return EXIT_SUCCESS;
+
+}
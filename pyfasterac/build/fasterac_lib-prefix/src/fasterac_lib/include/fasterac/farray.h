@@ -27,7 +27,7 @@ typedef struct farray {
   size_t             space_size;
   //  data array
   faster_data_p*     data_array;
-  int                nb_data;
+  long long          nb_data;
   //  time width
   unsigned long long first_ns;
   unsigned long long last_ns;
@@ -37,12 +37,22 @@ typedef struct farray {
 
 int farray_data_file_to_memory (const char* filename, char** mem_space, size_t* mem_size);
   //
-  //  Allocate memory space and dump the file to that memory.
+  //  Put the file in memory : a raw file is mapped (private, writable),
+  //  a gzip file, a pipe or any non-regular file is read to a buffer.
+  //  At most 64 files are mapped at the same time, the next ones are
+  //  copied to buffers (slower, memory not shared with the page cache).
   //  Return the size of the memory space and a pointer to it (mem_space, mem_size).
   //  Return code : O on success, 1 on file error and 2 on memory error.
   //
   //  WARNING : the caller of that function has the RESPONSABILITY of the
-  //            allocated memory (ie deallocation).
+  //            memory space, released with farray_data_memory_free and
+  //            NOT with free () (a mapped space can not be freed, callers
+  //            written for the former malloc version must be changed).
+  //
+
+void farray_data_memory_free (char* mem_space, size_t mem_size);
+  //  Unmap or free a memory space of farray_data_file_to_memory
+  //  (or free a memory space of farray_data_file_to_memory_from_stdin).
   //
 
 int farray_data_file_to_memory_from_stdin (FILE* input, size_t size_max, char** mem_space, size_t* mem_size);
@@ -57,6 +67,7 @@ int farray_data_file_to_memory_from_stdin (FILE* input, size_t size_max, char**
 
 farray* farray_new (char* data_space, size_t space_size);
   //  Create new 'farray' with 'data_space'.
+  //  Returns null on memory error.
   //
 
 void farray_free (farray* far);
@@ -65,15 +76,21 @@ void farray_free (farray* far);
 
 //---  faster data array  ------------------------------------------------//
 
-int farray_previous_idx (const farray far, unsigned long long clock_ns);
+int farray_sort_by_clock (farray* far, int nb_threads);
+  //  Sorts the data array by clock (LSD radix sort on the 48 bits clock).
+  //  The sort is stable : data with equal clocks keep their order.
+  //  nb_threads > 1 shares each radix pass between threads.
+  //  Return code : 0 on success and 2 on memory error (array unchanged).
+
+long long farray_previous_idx (const farray far, unsigned long long clock_ns);
   //  Returns the index number of the oldest data before 'clock_ns'.
   //  Returns -1 on error;
 
-int farray_next_idx (const farray far, unsigned long long clock_ns);
+long long farray_next_idx (const farray far, unsigned long long clock_ns);
   //  Returns the index number of the youngest data after 'clock_ns'.
   //  Returns -1 on error;
 
-int farray_nearest_idx (const farray far, unsigned long long clock_ns);
+long long farray_nearest_idx (const farray far, unsigned long long clock_ns);
   //  Returns the index number of the nearest data to 'clock_ns'.
   //  Returns -1 on error;
 
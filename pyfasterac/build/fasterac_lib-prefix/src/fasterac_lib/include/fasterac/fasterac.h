@@ -101,6 +101,9 @@ typedef void* faster_file_reader_p;
 
 faster_file_reader_p  faster_file_reader_open (const char *filename);
   //  Opens the file and returns a new reader for it
+  //  Each reader starts a thread inflating the file ahead and allocates
+  //  3 blocks of 4MB (FASTER_READER_BLOCK_SIZE environment variable :
+  //  block size in bytes, 0 => no thread, data read one by one).
 
 void  faster_file_reader_close (faster_file_reader_p reader);
   //  Closes the file and frees the reader
@@ -111,6 +114,58 @@ faster_data_p faster_file_reader_next (faster_file_reader_p reader);
   //  Returns null if eof
 
 
+//
+//  MMAP READER
+//
+
+typedef void* faster_mmap_reader_p;
+  //  Pointer to a faster memory mapped file reader
+
+faster_mmap_reader_p faster_mmap_reader_open (const char *filename);
+  //  Maps the file in memory and returns a new reader for it
+  //  (compressed files, pipes and other non-regular files are
+  //   transparently read through a file reader)
+  //  Returns null on error
+
+void faster_mmap_reader_close (faster_mmap_reader_p reader);
+  //  Unmaps the file and frees the reader
+
+faster_data_p faster_mmap_reader_next (faster_mmap_reader_p reader);
+  //  Returns a pointer to the next data, directly within the mapped file
+  //  (that pointer stays valid until the reader is closed, except for
+  //   compressed files where it behaves as faster_file_reader_next)
+  //  Returns null if eof
+
+
+//
+//  PARALLEL READER
+//
+
+typedef void* (*faster_parallel_init_fn)  (int thread_num, void* user);
+  //  Returns the private context of a worker thread (histograms, counters, ...)
+
+typedef void  (*faster_parallel_data_fn)  (faster_data_p data, void* context);
+  //  Called in a worker thread for each data of its part of the file
+
+typedef void  (*faster_parallel_merge_fn) (void* context, void* user);
+  //  Called at the end for each worker, in the calling thread and in worker
+  //  order : merges the worker results into 'user' and frees the context
+
+int faster_file_parallel_read (const char*              filename,
+                               int                      nb_threads,
+                               faster_parallel_init_fn  init,
+                               faster_parallel_data_fn  process,
+                               faster_parallel_merge_fn merge,
+                               void*                    user);
+  //  Reads the whole file with 'nb_threads' workers (0 => nb of cores).
+  //  Uncompressed files are mapped and cut in large chunks, each worker
+  //  resynchronizing on the first data of its chunk ; compressed files (and
+  //  pipes) are read by the calling thread and dispatched to the workers by batches.
+  //  Data are processed in file order within a chunk, not between chunks.
+  //  Return code : 0 on success, 1 on file error, 2 on memory error and
+  //  3 when a chunk couldn't be resynchronized (corrupted file).
+
+
 //
 //  FILE WRITER
 //
@@ -118,15 +173,42 @@ faster_data_p faster_file_reader_next (faster_file_reader_p reader);
 typedef void* faster_file_writer_p;
   //  Pointer to a faster file writer
 
-faster_file_writer_p  faster_file_writer_open (const char *filename);
-  //  Opens the file and returns a new writer for it
+#define FASTER_WRITER_RAW            0
+#define FASTER_WRITER_GZIP           1
+#define FASTER_WRITER_ZSTD           2
+#define FASTER_WRITER_DEFAULT_LEVEL  1
 
-void faster_file_writer_close (faster_file_writer_p writer);
-  //  Closes the file and frees the writer
+faster_file_writer_p  faster_file_writer_open (const char *filename);
+  //  Opens the file and returns a new writer for it.
+  //  Names ending with '.gz' (or '.zst') are written compressed
+  //  (default level, one thread per core), others are raw.
+
+faster_file_writer_p  faster_file_writer_open_compressed (const char *filename, int format, int level, int nb_threads);
+  //
+  //  Opens the file with an output format :
+  //    FASTER_WRITER_RAW  : uncompressed,
+  //    FASTER_WRITER_GZIP : frames of 1MB deflated in parallel by 'nb_threads'
+  //                         threads (0 => nb of cores), each frame being a gzip
+  //                         member : the file is read by any gzip reader, the
+  //                         frames are the random access points of findex,
+  //    FASTER_WRITER_ZSTD : zstd seekable format (same frames, seek table at
+  //                         the end ; null when built without libzstd, not
+  //                         read by the faster readers).
+  //  'level' is the compression level of the format.
+  //  Returns null on error.
+  //
+
+int faster_file_writer_close (faster_file_writer_p writer);
+  //  Writes the pending frames, closes the file and frees the writer.
+  //  Return code : 0 on success, 1 on file error and 2 on memory error.
 
 void faster_file_writer_next (const faster_file_writer_p writer, const faster_data_p data);
   //  Write the data to the file
 
+int faster_file_writer_error (const faster_file_writer_p writer);
+  //  First error of the writer so far : 0, 1 (file) or 2 (memory).
+  //  The data given after that error are not written.
+
 
 #ifdef __cplusplus
 }
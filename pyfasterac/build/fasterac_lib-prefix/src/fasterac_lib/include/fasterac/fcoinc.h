@@ -0,0 +1,119 @@
+//
+//
+//  F C O I N C
+//
+//  Software coincidences of a time sorted stream of (ungrouped) data
+//
+//    - a window opens on the oldest pending hit, every hit within
+//      'window_ns' joins it, the group is emitted when it has at least
+//      'min_fold' hits and its hits are consumed (no extending window),
+//    - an optional time offset per label is added to the hit clocks,
+//    - accidentals : when 'delay_ns' is set, the hits in the delayed window
+//      [t0 + delay, t0 + delay + window) of each opened window are counted ;
+//      a delayed window with min_fold - 1 hits or more is an accidental.
+//
+//  Hits are kept in a ring buffer. The input may be slightly unsorted
+//  (label offsets, tolerance) : hits are inserted in order and a window is
+//  only closed when no later hit can fall into it. The cost per hit is
+//  O(1) amortized for a sorted input, and grows with the number of hits
+//  within the tolerance (a late hit is moved through them).
+//
+//
+
+
+
+#ifndef FCOINC_H
+#define FCOINC_H 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fasterac/fasterac.h"
+#include "fasterac/fcolumns.h"
+
+
+//---  coincidence structures  -------------------------------------------//
+
+typedef struct fcoinc_hit {
+  unsigned long long clock_ns;                            //  clock + label offset
+  unsigned short     label;
+  unsigned long long index;                               //  push order (or column index)
+  faster_data_p      data;                                //  copy of the data (null for columns)
+} fcoinc_hit;
+
+typedef void (*fcoinc_group_fn) (const fcoinc_hit* hits, int nb_hits, void* user);
+  //  Called for each coincidence group, hits in time order.
+  //  (the data are only valid during the call)
+
+typedef struct fcoinc_stats {
+  unsigned long long nb_hits;
+  unsigned long long nb_late;                             //  hits older than an already closed window
+  unsigned long long nb_windows;                          //  windows opened
+  unsigned long long nb_groups;                           //  groups emitted (>= min_fold)
+  unsigned long long nb_accidentals;                      //  delayed windows with >= min_fold - 1 hits
+  unsigned long long first_ns;
+  unsigned long long last_ns;
+  double             group_rate;                          //  groups per second
+  double             accidental_rate;                     //  accidentals per second
+} fcoinc_stats;
+
+typedef void* fcoinc_p;
+  //  Pointer to a coincidence builder
+
+
+//---  functions  --------------------------------------------------------//
+
+fcoinc_p fcoinc_open (unsigned long long window_ns, int min_fold, fcoinc_group_fn callback, void* user);
+  //  Returns a new coincidence builder (null on memory error).
+
+void fcoinc_set_offset (fcoinc_p fc, unsigned short label, long long offset_ns);
+  //  Time offset added to the clocks of a label (before any push).
+
+void fcoinc_set_delay (fcoinc_p fc, unsigned long long delay_ns);
+  //  Delayed window for accidentals (0 => none, >= window_ns otherwise).
+
+void fcoinc_set_tolerance (fcoinc_p fc, unsigned long long tolerance_ns);
+  //  Maximum lateness of a hit relative to the latest one pushed
+  //  (e.g. the data of a group may be older than the previous data).
+  //  Later hits are counted as late and dropped.
+
+int fcoinc_push (fcoinc_p fc, faster_data_p data);
+  //  Adds a data to the stream (groups are flattened).
+  //  Return code : 0 on success, 2 on memory error.
+
+int fcoinc_push_hit (fcoinc_p fc, unsigned long long clock_ns, unsigned short label, unsigned long long index);
+  //  Adds a hit without data.
+  //  Return code : 0 on success, 2 on memory error.
+
+int fcoinc_flush (fcoinc_p fc);
+  //  End of stream : closes all the pending windows.
+  //  Return code : 0 on success, 2 on memory error.
+
+void fcoinc_get_stats (fcoinc_p fc, fcoinc_stats* stats);
+  //  Counters and rates.
+
+void fcoinc_close (fcoinc_p fc);
+  //  Frees the builder (without flushing).
+
+int fcoinc_columns (const fcolumns* col, unsigned long long window_ns, int min_fold,
+                    const long long* offsets, unsigned long long delay_ns,
+                    long long* group_of_hit, fcoinc_stats* stats);
+  //
+  //  Coincidences of columns (whole file) : group_of_hit [i] receives the
+  //  group number of hit i (-1 if not in a group) ; offsets is null or an
+  //  array of 65536 label offsets. The columns must be time sorted, except
+  //  the data of a group : the tolerance is the disorder of the columns,
+  //  at most the largest clock span of a group. Later hits (e.g. a file
+  //  made of several sorted runs) are counted as late and dropped.
+  //  Stats may be null.
+  //  Return code : 0 on success, 2 on memory error.
+  //
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif  // FCOINC_H
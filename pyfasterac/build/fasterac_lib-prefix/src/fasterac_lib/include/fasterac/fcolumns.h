@@ -0,0 +1,87 @@
+//
+//
+//  F C O L U M N S
+//
+//  Columnar (structure of arrays) view of the charge / energy data of a
+//  file (qdc_x1, qdc_t_x1 and crrc4_spectro, grouped or not) :
+//
+//    label    [i]  unsigned short
+//    clock_ns [i]  unsigned long long
+//    q        [i]  int                  (q1 or spectro measure)
+//    flags    [i]  unsigned char (FCOLUMNS_xxx bits)
+//
+//  Column file ('.fcol') : a 64 bytes header followed by the columns,
+//  each one starting on a 64 bytes boundary at the position given by the
+//  header. It can be mapped as is, e.g. with numpy :
+//
+//    h     = np.fromfile (name, dtype=np.uint64, count=8)     #  h[1] nb_data, h[2..5] positions
+//    label = np.memmap   (name, dtype=np.uint16, mode='r', offset=h[2], shape=(h[1],))
+//
+//
+
+
+
+#ifndef FCOLUMNS_H
+#define FCOLUMNS_H 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include "fasterac/fasterac.h"
+
+
+//---  columns structure  ------------------------------------------------//
+
+#define FCOLUMNS_SATURATED    0x01         //  q1_saturated or spectro saturated
+#define FCOLUMNS_PILEUP       0x02         //  spectro pileup
+#define FCOLUMNS_GROUP_START  0x04         //  first column data of a group
+#define FCOLUMNS_IN_GROUP     0x08         //  data of a group
+
+typedef struct fcolumns {
+  unsigned long long  nb_data;
+  unsigned short*     label;
+  unsigned long long* clock_ns;
+  int*                q;
+  unsigned char*      flags;
+  //  private
+  void*               map;                 //  mapped column file (null => allocated columns)
+  size_t              map_size;
+  unsigned long long  max_data;
+} fcolumns;
+
+
+//---  functions  --------------------------------------------------------//
+
+int fcolumns_from_fast (const char* filename, fcolumns* col);
+  //
+  //  Decodes the qdc_x1, qdc_t_x1 and crrc4_spectro data of a faster file (.fast or .fast.gz)
+  //  into allocated columns, in file order, groups being flattened.
+  //  Return code : O on success, 1 on file error, 2 on memory error.
+  //
+  //  WARNING : the caller of that function has the RESPONSABILITY of the
+  //            columns (ie fcolumns_free).
+  //
+
+int fcolumns_write (const fcolumns* col, const char* colname);
+  //  Writes the columns to a column file.
+  //  Return code : O on success, 1 on file error.
+
+int fcolumns_map (const char* colname, fcolumns* col);
+  //
+  //  Maps a column file in memory, the columns pointing in the mapping
+  //  (no copy, read only).
+  //  Return code : O on success, 1 on file error and 3 on bad format.
+  //
+
+void fcolumns_free (fcolumns* col);
+  //  Frees (or unmaps) the columns.
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif  // FCOLUMNS_H
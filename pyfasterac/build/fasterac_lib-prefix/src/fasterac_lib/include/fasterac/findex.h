@@ -0,0 +1,178 @@
+//
+//
+//  F I N D E X
+//
+//  Time index of faster data files (sidecar file 'filename.fast.idx')
+//
+//  Each entry (a block of about 64KB of data) keeps the clock range and
+//  the label and type bitmaps of its data : the readers only decode the
+//  entries that may match their predicate (time window, labels, types).
+//
+//
+
+
+
+#ifndef FINDEX_H
+#define FINDEX_H 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fasterac/fasterac.h"
+
+
+//---  index structures  -------------------------------------------------//
+
+#define FINDEX_LABEL_BITMAP_SIZE 32
+  //  labels bitmap of an entry in bytes : bit (label % 256) set
+  //  when a data of that label is in the entry
+
+#define FINDEX_TYPE_BITMAP_SIZE 32
+  //  types bitmap of an entry in bytes : bit (type_alias) set
+  //  when a data of that type is in the entry
+
+#define FINDEX_BLOCK_SIZE 65536
+  //  max size in bytes of the data of an entry (unless a single data is larger)
+
+typedef struct findex_entry {
+  unsigned long long offset;                              //  byte offset of the first data (uncompressed)
+  unsigned long long min_ns;                              //  clock range of the entry data
+  unsigned long long max_ns;
+  unsigned int       nb_data;
+  unsigned int       reserved;
+  unsigned char      labels [FINDEX_LABEL_BITMAP_SIZE];
+  unsigned char      types  [FINDEX_TYPE_BITMAP_SIZE];
+} findex_entry;
+  //  An entry describes a slice of contiguous data of the file.
+  //  The bitmaps hold the data of the slice and the data of their groups.
+
+#define FINDEX_GZ_WINDOW_SIZE 32768
+
+typedef struct findex_gz_point {
+  unsigned long long out;                                 //  uncompressed offset
+  unsigned long long in;                                  //  compressed offset (first full byte)
+  int                bits;                                //  bits of the byte before 'in' (0 to 7),
+                                                          //  -1 : 'in' is the start of a gzip member
+  int                reserved;
+  unsigned long long window_pos;                          //  inflate dictionary position in the index file
+} findex_gz_point;
+  //  Inflate checkpoint of a compressed file (see zlib 'examples/zran.c').
+  //  The 32KB dictionaries stay in the index file until needed.
+  //  Files of the compressed writer have a checkpoint per frame (gzip
+  //  member) without dictionary.
+
+typedef struct findex {
+  char*              idxname;
+  int                is_gz;
+  unsigned long long nb_entries;
+  findex_entry*      entries;
+  unsigned long long nb_points;
+  findex_gz_point*   points;
+  unsigned long long data_size;                           //  data file when indexed
+  long long          data_mtime;
+} findex;
+
+
+//---  index file  -------------------------------------------------------//
+
+int findex_build (const char* filename, const char* idxname, unsigned int nb_data_step, unsigned long long step_ns);
+  //
+  //  Reads the whole data file and writes its index to 'idxname' : a new
+  //  entry every 'nb_data_step' data, every 'step_ns' ns (0 => no limit)
+  //  or every FINDEX_BLOCK_SIZE bytes.
+  //  For compressed files, inflate checkpoints are added every 1MB, or
+  //  taken from the frame headers for files of the compressed writer.
+  //  Return code : O on success, 1 on file error (or corrupt compressed
+  //  file) and 2 on memory error.
+  //
+
+int findex_read (const char* idxname, findex** idx);
+  //
+  //  Reads an index file (dictionaries excepted).
+  //  Return code : O on success, 1 on file error, 2 on memory error
+  //  and 3 on bad format (or index of an older version, to be rebuilt).
+  //  The data file is not read : see findex_check.
+  //
+  //  WARNING : the caller of that function has the RESPONSABILITY of the
+  //            allocated index (ie findex_free).
+  //
+
+int findex_check (const findex* idx, const char* filename);
+  //
+  //  Checks that the index is that of the data file : same size and same
+  //  modification time as when indexed.
+  //  Return code : O when up to date, 1 on file error and 3 when the
+  //  file has changed (index to be rebuilt, or full scan of the file).
+  //
+
+void findex_free (findex* idx);
+  //  Frees the index.
+
+void findex_filename (const char* filename, char* idxname);
+  //  Index filename of a data file ('filename.idx').
+
+
+//---  predicate  --------------------------------------------------------//
+
+#define FINDEX_LABEL_SET_SIZE 8192
+  //  labels set of a predicate in bytes (one bit per label)
+
+typedef struct findex_predicate {
+  unsigned long long from_ns;                             //  from_ns <= clock < to_ns
+  unsigned long long to_ns;
+  int                all_labels;                          //  no label selection
+  int                all_types;                           //  no type selection
+  unsigned char      labels [FINDEX_LABEL_SET_SIZE];
+  unsigned char      types  [FINDEX_TYPE_BITMAP_SIZE];
+} findex_predicate;
+  //  Data selection : a data matches when its clock is in the window and
+  //  when it, or one of the data of its group, has a selected label and
+  //  a selected type.
+
+void findex_predicate_init (findex_predicate* pred);
+  //  Selects all the data.
+
+void findex_predicate_window (findex_predicate* pred, unsigned long long from_ns, unsigned long long to_ns);
+  //  Selects the data such as from_ns <= clock < to_ns.
+
+void findex_predicate_label (findex_predicate* pred, unsigned short label);
+  //  Adds a label to the selected labels (all labels until the first call).
+
+void findex_predicate_type (findex_predicate* pred, unsigned char type_alias);
+  //  Adds a type to the selected types (all types until the first call).
+
+int findex_predicate_match (const findex_predicate* pred, faster_data_p data);
+  //  1 if the data matches the predicate, 0 otherwise.
+
+
+//---  readers  ----------------------------------------------------------//
+
+typedef void* findex_reader_p;
+  //  Pointer to an index reader
+
+findex_reader_p findex_reader_open (const char* filename, const findex* idx,
+                                    unsigned long long from_ns, unsigned long long to_ns);
+  //  Opens the file for reading data such as from_ns <= clock < to_ns.
+  //  Only the entries overlapping the window are decoded.
+  //  Returns null on error.
+
+findex_reader_p findex_reader_open_predicate (const char* filename, const findex* idx, const findex_predicate* pred);
+  //  Opens the file for reading the data matching 'pred' (copied).
+  //  The entries whose clock range or bitmaps can't match are skipped.
+  //  Returns null on error (or when the file has changed since indexed).
+
+faster_data_p findex_reader_next (findex_reader_p reader);
+  //  Returns the next selected data (null at end).
+  //  (current value of that pointer won't be available after the next 'next')
+
+void findex_reader_close (findex_reader_p reader);
+  //  Closes the file and frees the reader.
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif  // FINDEX_H
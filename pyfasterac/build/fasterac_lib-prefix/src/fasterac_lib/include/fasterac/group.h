@@ -13,6 +13,8 @@ typedef enum {
   GROUP_TYPE_ALIAS         =  10,
   // GROUP_COUNTER_TYPE_ALIAS =  30,
   GROUP_COUNTER_TYPE_ALIAS =  30,
+  GROUP_DATA_HEADER_SIZE   =  12,                         //  header of the grouped data
+  GROUP_MAX_DEPTH          =  16                          //  nested groups flattened by group_ungroup
 } group_const;
 
 typedef struct group_counter {
@@ -28,28 +30,105 @@ static size_t GROUP_COUNTER_TYPE_SIZE = sizeof (group_counter);
 
 int group_counter_set_value  (faster_data_p data, unsigned int multiplicity, unsigned int delta_time);
 
+//  GROUP ITERATION (no allocation)
+//
+//  group_iter walks the data of one group in place :
+//
+//    group_iter    it;
+//    faster_data_p d;
+//    group_iter_init (&it, group);
+//    while ((d = group_iter_next (&it)) != NULL) { ... }
+//
+//  group_ungroup flattens a data (group or not) : it yields the leaf data
+//  of the nested groups in order, depth first, each with the clock of its
+//  parent group (its own clock when it is not grouped). The open groups
+//  are kept on a fixed stack of GROUP_MAX_DEPTH iterators ; deeper groups
+//  are yielded as they are.
+//  The data returned point into the group, valid as long as the group is.
+
+typedef struct group_iter {
+  unsigned char* next;
+  unsigned char* end;
+} group_iter;
+
+typedef struct group_ungroup {
+  group_iter         stack [GROUP_MAX_DEPTH];
+  unsigned long long clock [GROUP_MAX_DEPTH];             //  clocks of the open groups
+  int                depth;                               //  nb of open groups
+  faster_data_p      single;                              //  data not grouped, not yet returned
+} group_ungroup;
+
+
+static inline void group_iter_init (group_iter* it, faster_data_p group) {
+  it->next = (unsigned char*) faster_data_load_p (group);
+  it->end  = it->next + faster_data_load_size (group);
+}
+
+static inline faster_data_p group_iter_next (group_iter* it) {
+  faster_data_p data;
+  if (it->next + GROUP_DATA_HEADER_SIZE > it->end) return NULL;
+  data      = (faster_data_p) it->next;
+  it->next += GROUP_DATA_HEADER_SIZE + faster_data_load_size (data);
+  if (it->next > it->end) return NULL;                    //  truncated group
+  return data;
+}
+
+
+static inline void group_ungroup_init (group_ungroup* ug, faster_data_p data) {
+  ug->depth  = 0;
+  ug->single = NULL;
+  if (faster_data_type_alias (data) == GROUP_TYPE_ALIAS) {
+    group_iter_init (&ug->stack [0], data);
+    ug->clock [0] = faster_data_clock_ns (data);
+    ug->depth     = 1;
+  } else {
+    ug->single = data;
+  }
+}
+
+static inline faster_data_p group_ungroup_next (group_ungroup* ug, unsigned long long* group_clock_ns) {
+  faster_data_p data;
+  if (ug->single != NULL) {
+    data       = ug->single;
+    ug->single = NULL;
+    if (group_clock_ns != NULL) *group_clock_ns = faster_data_clock_ns (data);
+    return data;
+  }
+  while (ug->depth > 0) {
+    data = group_iter_next (&ug->stack [ug->depth - 1]);
+    if (data == NULL) {                                   //  end of that group
+      ug->depth -= 1;
+    } else if (faster_data_type_alias (data) == GROUP_TYPE_ALIAS && ug->depth < GROUP_MAX_DEPTH) {
+      group_iter_init (&ug->stack [ug->depth], data);     //  nested group
+      ug->clock [ug->depth] = faster_data_clock_ns (data);
+      ug->depth            += 1;
+    } else {
+      if (group_clock_ns != NULL) *group_clock_ns = ug->clock [ug->depth - 1];
+      return data;
+    }
+  }
+  return NULL;
+}
+
+
 //  DATA TO STRING (used by faster_disfast)
 
 static inline void group_attributes_str (faster_data_p data, char* group_str) {     // for documentation purpose :
    unsigned char          alias;                                                    // this is not the one called in faster_disfast
    unsigned short         label;
-   unsigned short         lsize;
    unsigned long long     clock;
-   faster_buffer_reader_p group_reader;
-   void*                  group_buffer;
+   group_iter             group_it;
    faster_data_p          group_data;
    int                    group_n = 0;
    alias = faster_data_type_alias (data);
    label = faster_data_label      (data);
-   lsize = faster_data_load_size  (data);
    clock = faster_data_clock_ns   (data);
    sprintf (group_str, "%15s %5d  %lld ns\n", GROUP_TYPE_NAME, label, clock);
    if (alias == GROUP_TYPE_ALIAS) {
-      group_buffer = faster_data_load_p (data);
-      group_reader = faster_buffer_reader_open (group_buffer, lsize);
+      group_iter_init (&group_it, data);
       sprintf (group_str, "%s   ", group_str);
       sprintf (group_str, "%s           -------------------------------------------\n", group_str);
-      while ((group_data = faster_buffer_reader_next (group_reader)) != NULL) {
+      while ((group_data = group_iter_next (&group_it)) != NULL) {
          group_n += 1;
          alias = faster_data_type_alias (group_data);
          label = faster_data_label      (group_data);
@@ -60,7 +139,6 @@ static inline void group_attributes_str (faster_data_p data, char* group_str) {
       }
       sprintf (group_str, "%s   ", group_str);
       sprintf (group_str, "%s           -------------------------------------------\n", group_str);
-      faster_buffer_reader_close (group_reader);
    }
 }
 
@@ -0,0 +1,288 @@
+//
+//
+//  R E C O R D S
+//
+//  Header only C++ layer (C++11) : inline data accessors and typed views.
+//
+//    - fasterac::data_* : inline versions of faster_data_type_alias,
+//      faster_data_label, faster_data_clock_ns, ... (no call per field),
+//    - record / record_view<T> : a data seen in place, record_view<T>
+//      giving its load as a T (qdc_t_x1, crrc4_spectro, ...) without copy,
+//    - records<T> : range of the data of type T of a buffer, groups
+//      flattened (nested groups up to GROUP_MAX_DEPTH),
+//    - file_memory : a file in memory (mapped when not compressed).
+//
+//    fasterac::file_memory file ("run.fast");
+//    for (auto r : fasterac::records<qdc_t_x1> (file)) {
+//      histo [r.label ()] [r->q1] += 1;
+//    }
+//
+//  The payload type is bound to its type alias at compile time
+//  (fasterac::record_type<T>), the loop body is inlined and the payload
+//  is read where it lies.
+//
+//
+
+
+#ifndef FASTERAC_RECORDS_HPP
+#define FASTERAC_RECORDS_HPP 1
+
+#ifndef __cplusplus
+#error "fasterac/records.hpp is a C++ header"
+#endif
+
+#include <cstddef>
+#include <cstring>
+
+#include "fasterac/fasterac.h"
+#include "fasterac/fast_data.h"
+#include "fasterac/group.h"
+#include "fasterac/qdc.h"
+#include "fasterac/spectro.h"
+#include "fasterac/rf.h"
+#include "fasterac/qt2t.h"
+#include "fasterac/scaler.h"
+#include "fasterac/farray.h"
+
+
+namespace fasterac {
+
+
+//---  inline data accessors  --------------------------------------------//
+//
+//  Header : type_alias (1) magic (1) clock (6) label (2) load_size (2)
+//
+
+const std::size_t DATA_HEADER_SIZE = 12;
+
+inline unsigned char data_type_alias (const void* data) {
+  return *static_cast<const unsigned char*> (data);
+}
+
+inline unsigned short data_label (const void* data) {
+  unsigned short label;
+  std::memcpy (&label, static_cast<const unsigned char*> (data) + 8, sizeof (label));
+  return label;
+}
+
+inline unsigned short data_load_size (const void* data) {
+  unsigned short load_size;
+  std::memcpy (&load_size, static_cast<const unsigned char*> (data) + 10, sizeof (load_size));
+  return load_size;
+}
+
+inline unsigned long long data_clock_ns (const void* data) {       //  48 bits clock, 2 ns tick
+  unsigned long long word;
+  std::memcpy (&word, data, sizeof (word));
+  return (word >> 16) * 2;
+}
+
+inline const void* data_load_p (const void* data) {
+  return static_cast<const unsigned char*> (data) + DATA_HEADER_SIZE;
+}
+
+
+//---  payload types  ----------------------------------------------------//
+//
+//  record_type<T>::alias : type alias of the data whose load is a T.
+//  Other types are added the same way (FASTERAC_RECORD_TYPE).
+//
+
+template <typename T> struct record_type;
+
+#define FASTERAC_RECORD_TYPE(T, ALIAS) \
+  template <> struct record_type<T> { static const unsigned char alias = ALIAS; }
+
+FASTERAC_RECORD_TYPE (qdc_x1,             QDC_X1_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (qdc_x2,             QDC_X2_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (qdc_x3,             QDC_X3_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (qdc_x4,             QDC_X4_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (qdc_t_x1,           QDC_TDC_X1_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (qdc_t_x2,           QDC_TDC_X2_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (qdc_t_x3,           QDC_TDC_X3_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (qdc_t_x4,           QDC_TDC_X4_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (qdc_counter,        QDC_COUNTER_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (crrc4_spectro,      CRRC4_SPECTRO_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (trapez_spectro,     TRAPEZ_SPECTRO_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (spectro_counter,    SPECTRO_COUNTER_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (rf_data,            RF_DATA_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (rf_counter,         RF_COUNTER_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (qt2t,               QT2T_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (qt2t_counter,       QT2T_COUNTER_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (scaler_measurement, SCALER_MEASUREMENT_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (scaler_counter,     SCALER_COUNTER_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (tref_tdc,           TREF_TDC_TYPE_ALIAS);
+FASTERAC_RECORD_TYPE (group_counter,      GROUP_COUNTER_TYPE_ALIAS);
+
+
+//---  record views  -----------------------------------------------------//
+
+class record {
+  //  A data in place (untyped)
+public:
+  explicit record (const void* data) : data_ (static_cast<const unsigned char*> (data)) {}
+
+  unsigned char      type_alias () const { return data_type_alias (data_); }
+  unsigned short     label      () const { return data_label      (data_); }
+  unsigned long long clock_ns   () const { return data_clock_ns   (data_); }
+  unsigned short     load_size  () const { return data_load_size  (data_); }
+  const void*        load_p     () const { return data_load_p     (data_); }
+
+  faster_data_p      data () const { return (faster_data_p) data_; }   //  for the C API
+
+  template <typename T> bool is () const { return type_alias () == record_type<T>::alias; }
+
+protected:
+  const unsigned char* data_;
+};
+
+
+template <typename T>
+class record_view : public record {
+  //  A data of type record_type<T>::alias, its load read as a T
+public:
+  explicit record_view (const void* data) : record (data) {}
+
+  const T* operator-> () const { return static_cast<const T*> (load_p ()); }
+  const T& payload    () const { return *operator-> (); }
+};
+
+
+//---  ranges  -----------------------------------------------------------//
+
+namespace detail {
+
+template <typename T> struct record_match {
+  typedef record_view<T> view;
+  static bool match (unsigned char alias) { return alias == record_type<T>::alias; }
+};
+
+template <> struct record_match<void> {
+  typedef record view;
+  static bool match (unsigned char) { return true; }
+};
+
+}  // namespace detail
+
+
+template <typename T = void>
+class records {
+  //
+  //  Data of type T of a buffer (all the data when T is void),
+  //  in the order of the buffer. Groups are walked in place when
+  //  'ungroup' is set (default), returned as they are otherwise.
+  //  A truncated data ends the range.
+  //
+public:
+  typedef typename detail::record_match<T>::view view;
+
+  class iterator {
+  public:
+    iterator () : depth_ (-1), current_ (0), ungroup_ (false) {}
+    iterator (const unsigned char* begin, const unsigned char* end, bool ungroup)
+      : depth_ (0), current_ (0), ungroup_ (ungroup) {
+      next_ [0] = begin;
+      end_  [0] = end;
+      advance ();
+    }
+
+    view       operator*  () const { return view (current_); }
+    iterator&  operator++ ()       { advance (); return *this; }
+    bool       operator== (const iterator& it) const { return current_ == it.current_; }
+    bool       operator!= (const iterator& it) const { return current_ != it.current_; }
+
+  private:
+    void advance () {
+      while (depth_ >= 0) {
+        const unsigned char* data = next_ [depth_];
+        const unsigned char* next = data + DATA_HEADER_SIZE;
+        if (next > end_ [depth_]) {                       //  end of buffer or group
+          depth_ -= 1;
+          continue;
+        }
+        next += data_load_size (data);
+        if (next > end_ [depth_]) {                       //  truncated
+          depth_ -= 1;
+          continue;
+        }
+        next_ [depth_] = next;
+        if (ungroup_ && data [0] == GROUP_TYPE_ALIAS && depth_ < GROUP_MAX_DEPTH) {
+          depth_        += 1;
+          next_ [depth_] = data + DATA_HEADER_SIZE;
+          end_  [depth_] = next;
+          continue;
+        }
+        if (detail::record_match<T>::match (data [0])) {
+          current_ = data;
+          return;
+        }
+      }
+      current_ = 0;
+    }
+
+    const unsigned char* next_ [GROUP_MAX_DEPTH + 1];
+    const unsigned char* end_  [GROUP_MAX_DEPTH + 1];
+    int                  depth_;
+    const unsigned char* current_;
+    bool                 ungroup_;
+  };
+
+  records (const void* buffer, std::size_t size, bool ungroup = true)
+    : begin_ (static_cast<const unsigned char*> (buffer)),
+      end_   (static_cast<const unsigned char*> (buffer) + size),
+      ungroup_ (ungroup) {}
+
+  template <typename Memory>
+  explicit records (const Memory& memory)                         //  file_memory (any data () / size ())
+    : begin_ (static_cast<const unsigned char*> (memory.data ())),
+      end_   (static_cast<const unsigned char*> (memory.data ()) + memory.size ()),
+      ungroup_ (true) {}
+
+  iterator begin () const { return iterator (begin_, end_, ungroup_); }
+  iterator end   () const { return iterator (); }
+
+private:
+  const unsigned char* begin_;
+  const unsigned char* end_;
+  bool                 ungroup_;
+};
+
+
+template <typename T>
+records<T> group_records (const record& group) {
+  //  Data of type T within a group
+  return records<T> (group.load_p (), group.load_size ());
+}
+
+
+//---  file in memory  ---------------------------------------------------//
+
+class file_memory {
+  //
+  //  farray_data_file_to_memory : raw files are mapped, gzip files inflated.
+  //  error () : 0 on success, 1 on file error and 2 on memory error.
+  //
+public:
+  explicit file_memory (const char* filename) : space_ (0), size_ (0) {
+    error_ = farray_data_file_to_memory (filename, &space_, &size_);
+  }
+  ~file_memory () { farray_data_memory_free (space_, size_); }
+
+  const void* data  () const { return space_; }
+  std::size_t size  () const { return size_; }
+  int         error () const { return error_; }
+
+  file_memory (const file_memory&)            = delete;
+  file_memory& operator= (const file_memory&) = delete;
+
+private:
+  char*       space_;
+  std::size_t size_;
+  int         error_;
+};
+
+
+}  // namespace fasterac
+
+
+#endif  // FASTERAC_RECORDS_HPP
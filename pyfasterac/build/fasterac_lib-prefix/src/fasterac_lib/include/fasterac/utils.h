@@ -51,13 +51,13 @@ const int  tunit_coef [4]    = {1, 1000, 1000000, 1000000000};
 //
 //
 
-void data_display (faster_data_p data, int n, int tab, int full);
+void data_display (faster_data_p data, long long n, int tab, int full);
 //  print a faster data in console
 //  n    : data number
 //  tab  : number of tabs added at beginning
 //  full : data info (0=reduced, 1=full)
 
-void relative_data_display (faster_data_p data, int n, int tab, int full, unsigned long long ref_ns, time_unit tunit);
+void relative_data_display (faster_data_p data, long long n, int tab, int full, unsigned long long ref_ns, time_unit tunit);
 //  same display as 'data_display' + relative clock ref (ns) and time unit selection
 //
 
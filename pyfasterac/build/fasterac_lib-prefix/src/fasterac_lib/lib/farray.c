@@ -1,5 +1,12 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <zlib.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "fasterac/farray.h"
 
@@ -31,29 +38,31 @@ void farray_reset (farray* far) {
 
 //--------------------------------------------------//
 
-void farray_set_data_space (farray* far, char* data_space, size_t space_size) {
+int farray_set_data_space (farray* far, char* data_space, size_t space_size) {
   //
   faster_data_p          data;
   faster_buffer_reader_p reader;
-  int i;
+  long long              n = 0;
   //
   farray_reset (far);
   far->data_space = data_space;
   far->space_size = space_size;
-  far->data_array = (faster_data_p*) malloc (sizeof (faster_data_p) * far->space_size / 12);
+  //  counting pass (headers only) => exact array size
   reader = faster_buffer_reader_open (far->data_space, far->space_size);
-  if ((data = faster_buffer_reader_next (reader)) != NULL) {
-    far->data_array [0] = data;
-    far->first_ns       = faster_data_clock_ns (data);
-    far->nb_data        = 1;
-  }
-  while ((data = faster_buffer_reader_next (reader)) != NULL) {
+  while (faster_buffer_reader_next (reader) != NULL) n++;
+  faster_buffer_reader_close (reader);
+  if (n == 0) return 0;
+  far->data_array = (faster_data_p*) malloc (sizeof (faster_data_p) * n);
+  if (far->data_array == NULL) return 2;
+  reader = faster_buffer_reader_open (far->data_space, far->space_size);
+  while ((data = faster_buffer_reader_next (reader)) != NULL && far->nb_data < n) {
     far->data_array [far->nb_data] = data;
-    far->last_ns                   = faster_data_clock_ns (data);
-    far->nb_data                   = far->nb_data + 1;
+    far->nb_data                    = far->nb_data + 1;
   }
   faster_buffer_reader_close (reader);
-  far->data_array = (faster_data_p*) realloc (far->data_array, sizeof (faster_data_p) * far->nb_data);
+  far->first_ns = faster_data_clock_ns (far->data_array [0]);
+  far->last_ns  = faster_data_clock_ns (far->data_array [far->nb_data - 1]);
+  return 0;
 }
 
 int farray_data_file_to_memory_from_stdin (FILE* input, size_t size_max, char** mem_space, size_t* mem_size) {
@@ -78,44 +87,215 @@ int farray_data_file_to_memory_from_stdin (FILE* input, size_t size_max, char**
 
 
 //--------------------------------------------------//
+//
+//  File to memory :
+//    - raw files are mapped (private copy on write), the pages are read
+//      on demand and shared with the page cache,
+//    - gzip files are inflated into a buffer sized from the ISIZE trailer
+//      and the compressed size, doubled when too small (realloc of large
+//      blocks remaps the pages, nothing is copied) and trimmed at the end,
+//    - pipes and other non-regular files (no size, no mapping) go through
+//      the same growing buffer (gzread also reads raw data).
+//  The mapped spaces are recorded so that farray_data_memory_free knows
+//  whether to unmap or free.
+//
+
+#define FARRAY_MAX_MAPS  64
+#define FARRAY_GZ_RATIO  4                                //  first guess of the inflated size
+#define FARRAY_GZ_CHUNK  (1 << 30)                        //  gzread length is an unsigned int
+#define FARRAY_GZ_MIN    (1 << 20)                        //  first buffer of a stream of unknown size
+
+static struct {
+  char*  space;
+  size_t size;
+} farray_maps [FARRAY_MAX_MAPS];
+static pthread_mutex_t farray_maps_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static int farray_map_record (char* space, size_t size) {
+  int i;
+  int ok = 0;
+  pthread_mutex_lock (&farray_maps_lock);
+  for (i=0; i<FARRAY_MAX_MAPS; i++) {
+    if (farray_maps [i].space == NULL) {
+      farray_maps [i].space = space;
+      farray_maps [i].size  = size;
+      ok = 1;
+      break;
+    }
+  }
+  pthread_mutex_unlock (&farray_maps_lock);
+  return ok;
+}
 
-int farray_data_file_to_memory (const char* filename, char** mem_space, size_t* mem_size) {
-  //
-  gzFile f;
-  size_t ini_size = 3000000000;
-  size_t buf_size = 22000000;
-  size_t out_size = 0;
 
-  if (getenv ("FARRAY_FILE_SIZE") != NULL) {
-    ini_size = atol (getenv ("FARRAY_FILE_SIZE"));
-    //  printf ("farray init file size = %ld\n", ini_size);
+static int farray_map_forget (char* space) {
+  int i;
+  int found = 0;
+  pthread_mutex_lock (&farray_maps_lock);
+  for (i=0; i<FARRAY_MAX_MAPS; i++) {
+    if (farray_maps [i].space == space) {
+      farray_maps [i].space = NULL;
+      farray_maps [i].size  = 0;
+      found = 1;
+      break;
+    }
   }
+  pthread_mutex_unlock (&farray_maps_lock);
+  return found;
+}
 
-  *mem_space = (char*) malloc (ini_size);
-  if (*mem_space == NULL) {
-    *mem_size = 0;
+
+static int farray_gz_file_to_memory (int fd, size_t file_size, size_t isize,
+                                     char** mem_space, size_t* mem_size) {
+  //  fd is read from its current offset and closed
+  gzFile f;
+  char*  space;
+  size_t capacity;
+  size_t out_size = 0;
+  size_t len;
+  int    n;
+
+  capacity = file_size * FARRAY_GZ_RATIO;                 //  ISIZE is modulo 2^32 and
+  if (capacity < isize) capacity = isize;                 //  only that of the last member
+  if (capacity < FARRAY_GZ_MIN && file_size == 0) capacity = FARRAY_GZ_MIN;
+  capacity = capacity + 1;                                //  +1 => short read at the end
+  space = (char*) malloc (capacity);
+  if (space == NULL) {
+    close (fd);
     return 2;
   }
-  f = gzopen  (filename, "r");
+  f = gzdopen (fd, "r");
   if (f == NULL) {
-     return 1;
+    close (fd);
+    free (space);
+    return 1;
   }
-  while (gzeof (f) == 0) {
-     out_size += gzread (f, *mem_space + out_size, buf_size);
-     if (out_size > ini_size) return 3;
+  gzbuffer (f, 1 << 18);
+  for (;;) {
+    if (out_size == capacity) {
+      char* grown = (char*) realloc (space, 2 * capacity);
+      if (grown == NULL) {
+        gzclose (f);
+        free (space);
+        return 2;
+      }
+      space    = grown;
+      capacity = 2 * capacity;
+    }
+    len = capacity - out_size;
+    if (len > FARRAY_GZ_CHUNK) len = FARRAY_GZ_CHUNK;
+    n = gzread (f, space + out_size, len);
+    if (n < 0) {
+      gzclose (f);
+      free (space);
+      return 1;
+    }
+    out_size += n;
+    if ((size_t) n < len) break;
   }
   gzclose (f);
-  *mem_space = (char*) realloc (*mem_space, out_size);
+  if (out_size == 0) {
+    free (space);
+    space = NULL;
+  } else if (out_size < capacity) {
+    char* trimmed = (char*) realloc (space, out_size);
+    if (trimmed != NULL) space = trimmed;
+  }
+  *mem_space = space;
   *mem_size  = out_size;
   return 0;
 }
 
+
+static int farray_raw_file_to_memory (int fd, size_t file_size, char** mem_space, size_t* mem_size) {
+  //  fd is read from offset 0 and closed
+  char*   space;
+  size_t  done = 0;
+  ssize_t n;
+  space = (char*) malloc (file_size);
+  if (space == NULL) {
+    close (fd);
+    return 2;
+  }
+  while (done < file_size) {
+    n = pread (fd, space + done, file_size - done, done);
+    if (n <= 0) {
+      close (fd);
+      free (space);
+      return 1;
+    }
+    done += n;
+  }
+  close (fd);
+  *mem_space = space;
+  *mem_size  = file_size;
+  return 0;
+}
+
+
+int farray_data_file_to_memory (const char* filename, char** mem_space, size_t* mem_size) {
+  //
+  struct stat   st;
+  unsigned char head [2];
+  unsigned char tail [4];
+  size_t        isize = 0;
+  char*         map;
+  int           fd;
+
+  *mem_space = NULL;
+  *mem_size  = 0;
+  fd = open (filename, O_RDONLY);
+  if (fd < 0) return 1;
+  if (fstat (fd, &st) != 0) {
+    close (fd);
+    return 1;
+  }
+  if (!S_ISREG (st.st_mode)) {                            //  pipe, /dev/stdin, <(zcat ...)
+    return farray_gz_file_to_memory (fd, 0, 0, mem_space, mem_size);
+  }
+  if (st.st_size >= 18 && pread (fd, head, 2, 0) == 2 && head [0] == 0x1f && head [1] == 0x8b) {
+    if (pread (fd, tail, 4, st.st_size - 4) == 4) {
+      isize = tail [0] | (tail [1] << 8) | (tail [2] << 16) | ((size_t) tail [3] << 24);
+    }
+    return farray_gz_file_to_memory (fd, st.st_size, isize, mem_space, mem_size);
+  }
+  if (st.st_size == 0) {
+    close (fd);
+    return 0;
+  }
+  map = (char*) mmap (NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) {
+    close (fd);
+    return 2;
+  }
+  if (!farray_map_record (map, st.st_size)) {             //  too many maps => plain copy
+    munmap (map, st.st_size);
+    return farray_raw_file_to_memory (fd, st.st_size, mem_space, mem_size);
+  }
+  close (fd);                                             //  the mapping keeps the file
+  *mem_space = map;
+  *mem_size  = st.st_size;
+  return 0;
+}
+
+
+void farray_data_memory_free (char* mem_space, size_t mem_size) {
+  if (mem_space == NULL) return;
+  if (farray_map_forget (mem_space)) munmap (mem_space, mem_size);
+  else                               free   (mem_space);
+}
+
 //--------------------------------------------------//
 
 farray* farray_new (char* data_space, size_t space_size) {
   farray* far;
   far = (farray*) malloc (sizeof (farray));
-  farray_set_data_space (far, data_space, space_size);
+  if (far == NULL) return NULL;
+  if (farray_set_data_space (far, data_space, space_size) != 0) {
+    free (far);
+    return NULL;
+  }
   return far;
 }
 
@@ -129,13 +309,13 @@ void farray_free (farray* far) {
 
 //--------------------------------------------------//
 
-int farray_nearest_idx (const farray far, unsigned long long clock_ns) {
+long long farray_nearest_idx (const farray far, unsigned long long clock_ns) {
   unsigned long long t;
            long long dt1;
            long long dt2;
-  int idx  = -1;
-  int idx1 = 0;
-  int idx2 = far.nb_data - 1;
+  long long idx  = -1;
+  long long idx1 = 0;
+  long long idx2 = far.nb_data - 1;
   if (far.first_ns > clock_ns) return idx1;
   if (far.last_ns  < clock_ns) return idx2;
   while (idx2 - idx1 > 1) {
@@ -146,10 +326,10 @@ int farray_nearest_idx (const farray far, unsigned long long clock_ns) {
     } else {
       idx1 = idx;
     }
-    dt1 = clock_ns - faster_data_clock_ns (far.data_array [idx1]);
-    dt2 = clock_ns - faster_data_clock_ns (far.data_array [idx2]);
   }
-  int nearest_index;
+  dt1 = clock_ns - faster_data_clock_ns (far.data_array [idx1]);
+  dt2 = clock_ns - faster_data_clock_ns (far.data_array [idx2]);
+  long long nearest_index;
   if ( llabs (dt1) < llabs (dt2) ) nearest_index = idx1;
   else nearest_index = idx2;
 
@@ -162,9 +342,9 @@ int farray_nearest_idx (const farray far, unsigned long long clock_ns) {
 }
 
 
-int farray_next_idx (const farray far, unsigned long long clock_ns) {
+long long farray_next_idx (const farray far, unsigned long long clock_ns) {
   unsigned long long t;
-  int                idx;
+  long long          idx;
   if (far.last_ns  <= clock_ns) return -1;
   if (far.first_ns >  clock_ns) return  0;
   idx = farray_nearest_idx (far, clock_ns);
@@ -174,9 +354,9 @@ int farray_next_idx (const farray far, unsigned long long clock_ns) {
 }
 
 
-int farray_previous_idx (const farray far, unsigned long long clock_ns) {
+long long farray_previous_idx (const farray far, unsigned long long clock_ns) {
   unsigned long long t;
-  int                idx;
+  long long          idx;
   if (far.first_ns >= clock_ns) return  -1;
   if (far.last_ns  <  clock_ns) return  far.nb_data - 1;
   idx = farray_nearest_idx (far, clock_ns);
@@ -186,6 +366,153 @@ int farray_previous_idx (const farray far, unsigned long long clock_ns) {
 }
 
 //--------------------------------------------------//
+//
+//  Sort by clock : LSD radix sort, 3 passes of 16 bits on the 48 bits clock.
+//  Keys are packed (clock, data) so that passes don't touch the data.
+//
+
+#define RADIX_BITS    16
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES  3
+
+typedef struct clock_key {
+  unsigned long long clock;
+  faster_data_p      data;
+} clock_key;
+
+typedef struct radix_job {
+  clock_key* src;
+  clock_key* dst;
+  size_t     first;
+  size_t     last;
+  int        shift;
+  size_t*    count;                                       //  RADIX_BUCKETS counters (offsets)
+} radix_job;
+
+
+static inline unsigned long long data_clock48 (const faster_data_p data) {
+  return (*((unsigned long long*) data)) >> 16;           //  raw 48 bits clock (faster_data_clock_ns / 2)
+}
+
+
+static void* radix_count (void* arg) {
+  radix_job* job = (radix_job*) arg;
+  size_t     i;
+  memset (job->count, 0, sizeof (size_t) * RADIX_BUCKETS);
+  for (i=job->first; i<job->last; i++) {
+    job->count [(job->src [i].clock >> job->shift) & (RADIX_BUCKETS - 1)]++;
+  }
+  return NULL;
+}
+
+
+static void* radix_scatter (void* arg) {
+  radix_job* job = (radix_job*) arg;
+  size_t     i;
+  for (i=job->first; i<job->last; i++) {
+    job->dst [job->count [(job->src [i].clock >> job->shift) & (RADIX_BUCKETS - 1)]++] = job->src [i];
+  }
+  return NULL;
+}
+
 
+static void radix_run (void* (*func) (void*), radix_job* jobs, int nb_jobs) {
+  pthread_t* threads;
+  char*      started;
+  int        j;
+  threads = nb_jobs > 1 ? (pthread_t*) malloc (sizeof (pthread_t) * nb_jobs) : NULL;
+  started = nb_jobs > 1 ? (char*)      calloc (nb_jobs, 1)                   : NULL;
+  if (threads == NULL || started == NULL) {               //  single job or no memory => done here
+    for (j=0; j<nb_jobs; j++) func (&jobs [j]);
+    free (threads);
+    free (started);
+    return;
+  }
+  for (j=1; j<nb_jobs; j++) {
+    started [j] = pthread_create (&threads [j], NULL, func, &jobs [j]) == 0;
+    if (!started [j]) func (&jobs [j]);                   //  no thread => done here
+  }
+  func (&jobs [0]);
+  for (j=1; j<nb_jobs; j++) {
+    if (started [j]) pthread_join (threads [j], NULL);
+  }
+  free (threads);
+  free (started);
+}
 
 
+int farray_sort_by_clock (farray* far, int nb_threads) {
+  clock_key* keys;
+  clock_key* tmp;
+  clock_key* swap;
+  radix_job* jobs;
+  size_t     n = far->nb_data;
+  size_t     i;
+  size_t     offset;
+  size_t     count;
+  int        pass;
+  int        b;
+  int        j;
+
+  if (n < 2) return 0;
+  if (nb_threads < 1)           nb_threads = 1;
+  if ((size_t) nb_threads > n)  nb_threads = n;
+  keys = (clock_key*) malloc (sizeof (clock_key) * n);
+  tmp  = (clock_key*) malloc (sizeof (clock_key) * n);
+  jobs = (radix_job*) calloc (nb_threads, sizeof (radix_job));
+  for (j=0; jobs != NULL && j<nb_threads; j++) {
+    jobs [j].first = n *  j      / nb_threads;            //  contiguous slices => stable
+    jobs [j].last  = n * (j + 1) / nb_threads;
+    jobs [j].count = (size_t*) malloc (sizeof (size_t) * RADIX_BUCKETS);
+    if (jobs [j].count == NULL) break;
+  }
+  if (keys == NULL || tmp == NULL || jobs == NULL || j < nb_threads) {
+    for (j=0; jobs != NULL && j<nb_threads; j++) free (jobs [j].count);
+    free (keys);
+    free (tmp);
+    free (jobs);
+    return 2;
+  }
+  for (i=0; i<n; i++) {
+    keys [i].clock = data_clock48 (far->data_array [i]);
+    keys [i].data  = far->data_array [i];
+  }
+  for (pass=0; pass<RADIX_PASSES; pass++) {
+    for (j=0; j<nb_threads; j++) {
+      jobs [j].src   = keys;
+      jobs [j].dst   = tmp;
+      jobs [j].shift = pass * RADIX_BITS;
+    }
+    radix_run (radix_count, jobs, nb_threads);
+    //  every data in the same bucket => nothing to do for that pass
+    for (b=0; b<RADIX_BUCKETS; b++) {
+      offset = 0;
+      for (j=0; j<nb_threads; j++) offset += jobs [j].count [b];
+      if (offset != 0) break;
+    }
+    if (offset == n) continue;
+    //  bucket offsets, thread after thread within each bucket
+    offset = 0;
+    for (b=0; b<RADIX_BUCKETS; b++) {
+      for (j=0; j<nb_threads; j++) {
+        count              = jobs [j].count [b];
+        jobs [j].count [b] = offset;
+        offset             = offset + count;
+      }
+    }
+    radix_run (radix_scatter, jobs, nb_threads);
+    swap = keys;
+    keys = tmp;
+    tmp  = swap;
+  }
+  for (i=0; i<n; i++) far->data_array [i] = keys [i].data;
+  far->first_ns = faster_data_clock_ns (far->data_array [0]);
+  far->last_ns  = faster_data_clock_ns (far->data_array [n - 1]);
+  for (j=0; j<nb_threads; j++) free (jobs [j].count);
+  free (jobs);
+  free (keys);
+  free (tmp);
+  return 0;
+}
+
+//--------------------------------------------------//
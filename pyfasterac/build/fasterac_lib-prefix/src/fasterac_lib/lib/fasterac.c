@@ -2,6 +2,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <zlib.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined (HAVE_ZSTD_H) && defined (HAVE_LIBZSTD)
+#define FASTER_WITH_ZSTD 1
+#include <zstd.h>
+#endif
 
 #include "fasterac/fasterac.h"
 
@@ -200,30 +210,191 @@ void* faster_buffer_reader_current_position (const faster_buffer_reader_p reader
 
 
 //  FILE READER
+//
+//  The file is inflated by large blocks on a dedicated thread (read ahead),
+//  while the caller walks the data of the current block.
+//  A data overlapping two blocks is copied into the 'current' data, sized
+//  for the largest data (load_size up to 65535) as the data of a block.
+//  Block size can be set with the environment variable FASTER_READER_BLOCK_SIZE
+//  (in bytes, 0 => no thread, data are read one by one from the file).
+
+#define FASTER_READER_BLOCK_SIZE 4194304
+#define FASTER_READER_NB_BLOCKS  3
+#define FASTER_READER_DATA_SIZE  (sizeof (faster_data_header_t) + 65535)
 
 typedef struct faster_file_reader_t {
-  faster_data_t *current;
+  faster_data_t   *current;
   gzFile           file;
+  //  read ahead
+  int              threaded;
+  pthread_t        thread;
+  pthread_mutex_t  lock;
+  pthread_cond_t   filled;
+  pthread_cond_t   emptied;
+  unsigned char   *block     [FASTER_READER_NB_BLOCKS];
+  size_t           block_len [FASTER_READER_NB_BLOCKS];
+  size_t           block_size;
+  int              nb_filled;                    //  blocks filled, including the one in use
+  int              w_idx;                        //  block being inflated
+  int              r_idx;                        //  block in use
+  int              eof;
+  int              stop;
+  int              in_use;
+  unsigned char   *pos;                          //  position in the block in use
+  unsigned char   *end;
 } faster_file_reader_t;
 
 
+static void* faster_file_reader_inflate (void* reader) {
+  faster_file_reader_t *ffr = (faster_file_reader_t*) reader;
+  int                   idx;
+  int                   n;
+  while (1) {
+    pthread_mutex_lock (&ffr->lock);
+    while (ffr->nb_filled == FASTER_READER_NB_BLOCKS && !ffr->stop) {
+      pthread_cond_wait (&ffr->emptied, &ffr->lock);
+    }
+    if (ffr->stop) {
+      pthread_mutex_unlock (&ffr->lock);
+      return NULL;
+    }
+    idx = ffr->w_idx;
+    pthread_mutex_unlock (&ffr->lock);
+    n = gzread (ffr->file, ffr->block [idx], ffr->block_size);
+    pthread_mutex_lock (&ffr->lock);
+    if (n > 0) {
+      ffr->block_len [idx] = n;
+      ffr->w_idx           = (idx + 1) % FASTER_READER_NB_BLOCKS;
+      ffr->nb_filled       = ffr->nb_filled + 1;
+    }
+    if (n < (int) ffr->block_size) {            //  eof or error
+      ffr->eof = 1;
+    }
+    pthread_cond_signal   (&ffr->filled);
+    pthread_mutex_unlock (&ffr->lock);
+    if (ffr->eof) return NULL;
+  }
+}
+
+
+static int faster_file_reader_acquire_block (faster_file_reader_t *ffr) {
+  pthread_mutex_lock (&ffr->lock);
+  while (ffr->nb_filled == 0 && !ffr->eof) {
+    pthread_cond_wait (&ffr->filled, &ffr->lock);
+  }
+  if (ffr->nb_filled == 0) {
+    pthread_mutex_unlock (&ffr->lock);
+    return 0;
+  }
+  ffr->pos    = ffr->block [ffr->r_idx];
+  ffr->end    = ffr->pos + ffr->block_len [ffr->r_idx];
+  ffr->in_use = 1;
+  pthread_mutex_unlock (&ffr->lock);
+  return 1;
+}
+
+
+static void faster_file_reader_release_block (faster_file_reader_t *ffr) {
+  pthread_mutex_lock (&ffr->lock);
+  ffr->r_idx     = (ffr->r_idx + 1) % FASTER_READER_NB_BLOCKS;
+  ffr->nb_filled = ffr->nb_filled - 1;
+  ffr->in_use    = 0;
+  pthread_cond_signal   (&ffr->emptied);
+  pthread_mutex_unlock (&ffr->lock);
+}
+
+
+static size_t faster_file_reader_copy (faster_file_reader_t *ffr, void* dest, size_t size) {
+  size_t copied = 0;
+  size_t n;
+  while (copied < size) {
+    if (ffr->pos == ffr->end) {
+      if (ffr->in_use) faster_file_reader_release_block (ffr);
+      if (!faster_file_reader_acquire_block (ffr)) break;
+    }
+    n = ffr->end - ffr->pos;
+    if (n > size - copied) n = size - copied;
+    memcpy ((char*) dest + copied, ffr->pos, n);
+    ffr->pos = ffr->pos + n;
+    copied   = copied   + n;
+  }
+  return copied;
+}
+
+
+static int faster_file_reader_start_thread (faster_file_reader_t *ffr) {
+  int i;
+  ffr->block_size = FASTER_READER_BLOCK_SIZE;
+  if (getenv ("FASTER_READER_BLOCK_SIZE") != NULL) {
+    ffr->block_size = atol (getenv ("FASTER_READER_BLOCK_SIZE"));
+  }
+  if (ffr->block_size == 0) return 0;
+  for (i=0; i<FASTER_READER_NB_BLOCKS; i++) {
+    ffr->block [i] = (unsigned char*) malloc (ffr->block_size);
+    if (ffr->block [i] == NULL) {
+      while (i > 0) free (ffr->block [--i]);
+      return 0;
+    }
+  }
+  ffr->nb_filled = 0;
+  ffr->w_idx     = 0;
+  ffr->r_idx     = 0;
+  ffr->eof       = 0;
+  ffr->stop      = 0;
+  ffr->in_use    = 0;
+  ffr->pos       = NULL;
+  ffr->end       = NULL;
+  pthread_mutex_init (&ffr->lock,    NULL);
+  pthread_cond_init  (&ffr->filled,  NULL);
+  pthread_cond_init  (&ffr->emptied, NULL);
+  if (pthread_create (&ffr->thread, NULL, faster_file_reader_inflate, ffr) != 0) {
+    pthread_mutex_destroy (&ffr->lock);
+    pthread_cond_destroy  (&ffr->filled);
+    pthread_cond_destroy  (&ffr->emptied);
+    for (i=0; i<FASTER_READER_NB_BLOCKS; i++) free (ffr->block [i]);
+    return 0;
+  }
+  return 1;
+}
+
+
 faster_file_reader_p faster_file_reader_open (const char *filename) {
   faster_file_reader_t *ffr;
   ffr       = (faster_file_reader_t*) malloc (sizeof (faster_file_reader_t));
+  if (ffr == NULL) return NULL;
   ffr->file = gzopen (filename, "r");
   if (ffr->file == NULL) {
     free (ffr);
     return NULL;
   }
-  ffr->current = (faster_data_t*) malloc (sizeof (faster_data_t));
+  gzbuffer (ffr->file, 1 << 20);
+  ffr->current  = (faster_data_t*) malloc (FASTER_READER_DATA_SIZE);
+  if (ffr->current == NULL) {
+    gzclose (ffr->file);
+    free (ffr);
+    return NULL;
+  }
+  ffr->threaded = faster_file_reader_start_thread (ffr);
   return ffr;
 }
 
 
 void  faster_file_reader_close (faster_file_reader_p reader) {
   faster_file_reader_t *ffr = (faster_file_reader_t*) reader;
+  int i;
 
   if (reader) {
+    if (ffr->threaded) {
+      pthread_mutex_lock (&ffr->lock);
+      ffr->stop = 1;
+      pthread_cond_signal   (&ffr->emptied);
+      pthread_mutex_unlock (&ffr->lock);
+      pthread_join (ffr->thread, NULL);
+      pthread_mutex_destroy (&ffr->lock);
+      pthread_cond_destroy  (&ffr->filled);
+      pthread_cond_destroy  (&ffr->emptied);
+      for (i=0; i<FASTER_READER_NB_BLOCKS; i++) free (ffr->block [i]);
+    }
     if (ffr->current != NULL) free (ffr->current);
     if (ffr->file    != NULL) gzclose (ffr->file);
     free (ffr);
@@ -232,9 +403,39 @@ void  faster_file_reader_close (faster_file_reader_p reader) {
 }
 
 
+static faster_data_p faster_file_reader_next_block (faster_file_reader_t *ffr) {
+  faster_data_t *d;
+  size_t         avail;
+  if (ffr->pos == ffr->end) {
+    if (ffr->in_use) faster_file_reader_release_block (ffr);
+    if (!faster_file_reader_acquire_block (ffr)) return NULL;
+  }
+  avail = ffr->end - ffr->pos;
+  if (avail >= sizeof (faster_data_header_t)) {
+    d = (faster_data_t*) ffr->pos;
+    if (avail >= sizeof (faster_data_header_t) + d->header.load_size) {
+      // whole data in the block
+      ffr->pos = ffr->pos + sizeof (faster_data_header_t) + d->header.load_size;
+      return d;
+    }
+  }
+  // data overlapping two blocks
+  if (faster_file_reader_copy (ffr, &ffr->current->header, sizeof (faster_data_header_t)) != sizeof (faster_data_header_t)) {
+    return NULL;
+  }
+  if (faster_file_reader_copy (ffr, &ffr->current->load, ffr->current->header.load_size) != ffr->current->header.load_size) {
+    return NULL;
+  }
+  return ffr->current;
+}
+
+
 faster_data_p faster_file_reader_next (faster_file_reader_p reader) {
   faster_file_reader_t *ffr = (faster_file_reader_t*) reader;
   int n;
+  if (ffr->threaded) {
+    return faster_file_reader_next_block (ffr);
+  }
   if (!gzeof (ffr->file)) {
     n = gzread (ffr->file, &ffr->current->header, sizeof (faster_data_header_t));
     if (n == sizeof (faster_data_header_t)) {
@@ -255,39 +456,733 @@ faster_data_p faster_file_reader_next (faster_file_reader_p reader) {
 }
 
 
+//  MMAP READER
+
+typedef struct faster_mmap_reader_t {
+  unsigned char        *map;
+  size_t                map_size;
+  unsigned char        *next;
+  unsigned char        *end;
+  faster_file_reader_p  gz_reader;
+} faster_mmap_reader_t;
+
+
+static int faster_is_gzip_file (int fd) {
+  unsigned char magic [2];
+  if (pread (fd, magic, 2, 0) != 2) return 0;
+  return (magic [0] == 0x1f) && (magic [1] == 0x8b);
+}
+
+
+faster_mmap_reader_p faster_mmap_reader_open (const char *filename) {
+  faster_mmap_reader_t *fmr;
+  struct stat           st;
+  int                   fd = -1;
+  if (stat (filename, &st) != 0) return NULL;
+  if (S_ISREG (st.st_mode)) {                        // pipes, /dev/stdin, ... : not opened twice
+    fd = open (filename, O_RDONLY);
+    if (fd < 0) return NULL;
+    if (fstat (fd, &st) != 0) {
+      close (fd);
+      return NULL;
+    }
+  }
+  fmr            = (faster_mmap_reader_t*) malloc (sizeof (faster_mmap_reader_t));
+  if (fmr == NULL) {
+    if (fd >= 0) close (fd);
+    return NULL;
+  }
+  fmr->map       = NULL;
+  fmr->map_size  = 0;
+  fmr->next      = NULL;
+  fmr->end       = NULL;
+  fmr->gz_reader = NULL;
+  if (fd < 0 || faster_is_gzip_file (fd)) {
+    // compressed or not a regular file : nothing to map, fall back to the gz file reader
+    if (fd >= 0) close (fd);
+    fmr->gz_reader = faster_file_reader_open (filename);
+    if (fmr->gz_reader == NULL) {
+      free (fmr);
+      return NULL;
+    }
+    return fmr;
+  }
+  if (st.st_size > 0) {
+    fmr->map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (fmr->map == MAP_FAILED) {
+      close (fd);
+      free  (fmr);
+      return NULL;
+    }
+    fmr->map_size = st.st_size;
+    madvise (fmr->map, fmr->map_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise (fmr->map, fmr->map_size, MADV_HUGEPAGE);
+#endif
+  }
+  close (fd);                                        // the mapping keeps the file
+  fmr->next = fmr->map;
+  fmr->end  = fmr->map + fmr->map_size;
+  return fmr;
+}
+
+
+void faster_mmap_reader_close (faster_mmap_reader_p reader) {
+  faster_mmap_reader_t *fmr = (faster_mmap_reader_t*) reader;
+  if (reader) {
+    if (fmr->map       != NULL) munmap (fmr->map, fmr->map_size);
+    if (fmr->gz_reader != NULL) faster_file_reader_close (fmr->gz_reader);
+    free (fmr);
+    reader = NULL;
+  }
+}
+
+
+faster_data_p faster_mmap_reader_next (faster_mmap_reader_p reader) {
+  faster_mmap_reader_t *fmr = (faster_mmap_reader_t*) reader;
+  faster_data_t        *d;
+  if (fmr->gz_reader != NULL) {
+    return faster_file_reader_next (fmr->gz_reader);
+  }
+  if (fmr->next + sizeof (faster_data_header_t) > fmr->end) {
+    return NULL;
+  }
+  d = (faster_data_t*) fmr->next;
+  if (fmr->next + sizeof (faster_data_header_t) + d->header.load_size > fmr->end) {
+    // truncated data at end of file
+    return NULL;
+  }
+  fmr->next = fmr->next + sizeof (faster_data_header_t) + d->header.load_size;
+  return (faster_data_p) d;
+}
+
+
+//  PARALLEL READER
+//
+//  Uncompressed files : the mapped file is cut in chunks taken by the workers
+//  in turn. A worker resynchronizes on the first position of its chunk where
+//  FASTER_PARALLEL_SYNC_DEPTH chained data have the magic byte and fit in the
+//  file. That position may be a data inside a group : the chain then rejoins
+//  the top level at the end of the group, less than one max data size later.
+//  So the chunk data start at the first chained position after that margin,
+//  and the chunk reads the data starting before the next chunk start plus
+//  the margin. At the end, each chunk must stop exactly where the next one
+//  has started.
+//  A chunk with no such position in its margin isn't processed (return 3).
+//  Compressed files, pipes and other non-regular files : the calling thread
+//  reads the file (file reader) and copies the data into batches processed
+//  by the workers.
+//  When no worker thread can be started, the calling thread reads the
+//  whole file itself.
+
+#define FASTER_PARALLEL_CHUNK_SIZE  8388608
+#define FASTER_PARALLEL_BATCH_SIZE  1048576
+#define FASTER_PARALLEL_SYNC_DEPTH  8
+#define FASTER_PARALLEL_SYNC_MARGIN (sizeof (faster_data_header_t) + 65535)
+
+typedef struct faster_parallel_t {
+  faster_parallel_data_fn  process;
+  //  mapped file
+  unsigned char           *map;
+  size_t                   map_size;
+  size_t                   nb_chunks;
+  size_t                   next_chunk;
+  size_t                  *starts;                 //  resynchronized position of each chunk
+  size_t                  *ends;                   //  position after the last data of each chunk
+  //  batches of a compressed file
+  int                      nb_batches;
+  unsigned char          **batch;
+  size_t                  *batch_len;
+  int                     *batch_state;            //  0 free, 1 filled, 2 in process
+  int                      eof;
+  pthread_mutex_t          lock;
+  pthread_cond_t           filled;
+  pthread_cond_t           emptied;
+} faster_parallel_t;
+
+typedef struct faster_parallel_worker_t {
+  faster_parallel_t       *par;
+  void                    *context;
+  pthread_t                thread;
+} faster_parallel_worker_t;
+
+
+static int faster_parallel_is_sync (const unsigned char *p, const unsigned char *end) {
+  int n;
+  for (n=0; n<FASTER_PARALLEL_SYNC_DEPTH; n++) {
+    if (p + sizeof (faster_data_header_t) > end) return 1;      //  end of file (possibly truncated)
+    if (((faster_data_header_t*) p)->magic != (unsigned char) FASTER_MAGIC) return 0;
+    p += sizeof (faster_data_header_t) + ((faster_data_header_t*) p)->load_size;
+  }
+  return 1;
+}
+
+
+static void* faster_parallel_map_worker (void* arg) {
+  faster_parallel_worker_t *w   = (faster_parallel_worker_t*) arg;
+  faster_parallel_t        *par = w->par;
+  unsigned char            *end = par->map + par->map_size;
+  unsigned char            *p;
+  unsigned char            *chunk_start;
+  unsigned char            *chunk_end;
+  size_t                    c;
+  while (1) {
+    pthread_mutex_lock   (&par->lock);
+    c = par->next_chunk++;
+    pthread_mutex_unlock (&par->lock);
+    if (c >= par->nb_chunks) break;
+    p           = par->map + c * FASTER_PARALLEL_CHUNK_SIZE;
+    chunk_start = p + FASTER_PARALLEL_SYNC_MARGIN;
+    chunk_end   = c == par->nb_chunks - 1 ? end : chunk_start + FASTER_PARALLEL_CHUNK_SIZE;
+    if (c > 0) {
+      while (p < chunk_start && !faster_parallel_is_sync (p, end)) p++;
+      if (p == chunk_start && !faster_parallel_is_sync (p, end)) {   //  not resynchronized : dropped
+        par->starts [c] = (size_t) -1;
+        par->ends   [c] = (size_t) -1;
+        continue;
+      }
+      while (p < chunk_start && p + sizeof (faster_data_header_t) <= end) {
+        if (p + sizeof (faster_data_header_t) + ((faster_data_header_t*) p)->load_size > end) break;  //  truncated
+        p += sizeof (faster_data_header_t) + ((faster_data_header_t*) p)->load_size;
+      }
+    }
+    par->starts [c] = p - par->map;
+    while (p < chunk_end && p + sizeof (faster_data_header_t) <= end) {
+      if (p + sizeof (faster_data_header_t) + ((faster_data_header_t*) p)->load_size > end) break;  //  truncated
+      par->process ((faster_data_p) p, w->context);
+      p += sizeof (faster_data_header_t) + ((faster_data_header_t*) p)->load_size;
+    }
+    par->ends [c] = p - par->map;
+  }
+  return NULL;
+}
+
+
+static void* faster_parallel_batch_worker (void* arg) {
+  faster_parallel_worker_t *w   = (faster_parallel_worker_t*) arg;
+  faster_parallel_t        *par = w->par;
+  unsigned char            *p;
+  unsigned char            *end;
+  int                       b;
+  while (1) {
+    pthread_mutex_lock (&par->lock);
+    while (1) {
+      for (b=0; b<par->nb_batches && par->batch_state [b] != 1; b++);
+      if (b < par->nb_batches || par->eof) break;
+      pthread_cond_wait (&par->filled, &par->lock);
+    }
+    if (b == par->nb_batches) {                              //  eof and nothing left
+      pthread_mutex_unlock (&par->lock);
+      break;
+    }
+    par->batch_state [b] = 2;
+    pthread_mutex_unlock (&par->lock);
+    p   = par->batch [b];
+    end = p + par->batch_len [b];
+    while (p < end) {
+      par->process ((faster_data_p) p, w->context);
+      p += sizeof (faster_data_header_t) + ((faster_data_header_t*) p)->load_size;
+    }
+    pthread_mutex_lock   (&par->lock);
+    par->batch_state [b] = 0;
+    pthread_cond_signal  (&par->emptied);
+    pthread_mutex_unlock (&par->lock);
+  }
+  return NULL;
+}
+
+
+static int faster_parallel_acquire_batch (faster_parallel_t *par) {
+  int b;
+  pthread_mutex_lock (&par->lock);
+  while (1) {
+    for (b=0; b<par->nb_batches && par->batch_state [b] != 0; b++);
+    if (b < par->nb_batches) break;
+    pthread_cond_wait (&par->emptied, &par->lock);
+  }
+  pthread_mutex_unlock (&par->lock);
+  par->batch_len [b] = 0;
+  return b;
+}
+
+
+static void faster_parallel_release_batch (faster_parallel_t *par, int b) {
+  pthread_mutex_lock   (&par->lock);
+  par->batch_state [b] = 1;
+  pthread_cond_signal  (&par->filled);
+  pthread_mutex_unlock (&par->lock);
+}
+
+
+static int faster_parallel_inflate (faster_parallel_t *par, const char *filename) {
+  faster_file_reader_p reader;
+  faster_data_p        data;
+  size_t               size;
+  int                  b;
+  reader = faster_file_reader_open (filename);
+  if (reader == NULL) return 1;
+  b = faster_parallel_acquire_batch (par);
+  while ((data = faster_file_reader_next (reader)) != NULL) {
+    size = sizeof (faster_data_header_t) + faster_data_load_size (data);
+    if (par->batch_len [b] + size > FASTER_PARALLEL_BATCH_SIZE) {
+      faster_parallel_release_batch (par, b);
+      b = faster_parallel_acquire_batch (par);
+    }
+    memcpy (par->batch [b] + par->batch_len [b], data, size);
+    par->batch_len [b] += size;
+  }
+  faster_parallel_release_batch (par, b);
+  faster_file_reader_close (reader);
+  return 0;
+}
+
+
+static int faster_parallel_serial (faster_parallel_t *par, const char *filename, void *context) {
+  faster_file_reader_p reader;
+  faster_data_p        data;
+  reader = faster_file_reader_open (filename);
+  if (reader == NULL) return 1;
+  while ((data = faster_file_reader_next (reader)) != NULL) par->process (data, context);
+  faster_file_reader_close (reader);
+  return 0;
+}
+
+
+int faster_file_parallel_read (const char*              filename,
+                               int                      nb_threads,
+                               faster_parallel_init_fn  init,
+                               faster_parallel_data_fn  process,
+                               faster_parallel_merge_fn merge,
+                               void*                    user) {
+  faster_parallel_t         par;
+  faster_parallel_worker_t *workers;
+  struct stat               st;
+  int                       fd = -1;
+  int                       is_gz = 1;                      //  read as a stream (file reader)
+  int                       err = 0;
+  int                       nb_started = 0;
+  int                       i;
+  size_t                    c;
+  if (nb_threads <= 0) nb_threads = sysconf (_SC_NPROCESSORS_ONLN);
+  if (nb_threads <= 0) nb_threads = 1;
+  memset (&par, 0, sizeof (par));
+  par.process = process;
+  if (stat (filename, &st) != 0) return 1;
+  if (S_ISREG (st.st_mode)) {                                 //  pipes, /dev/stdin, ... : not opened twice
+    fd = open (filename, O_RDONLY);
+    if (fd < 0) return 1;
+    if (fstat (fd, &st) != 0) {
+      close (fd);
+      return 1;
+    }
+    is_gz = faster_is_gzip_file (fd);
+  }
+  if (is_gz) {
+    par.nb_batches  = 2 * nb_threads + 1;
+    par.batch       = (unsigned char**) calloc (par.nb_batches, sizeof (unsigned char*));
+    par.batch_len   = (size_t*)         calloc (par.nb_batches, sizeof (size_t));
+    par.batch_state = (int*)            calloc (par.nb_batches, sizeof (int));
+    if (par.batch == NULL || par.batch_len == NULL || par.batch_state == NULL) err = 2;
+    for (i=0; !err && i<par.nb_batches; i++) {
+      par.batch [i] = (unsigned char*) malloc (FASTER_PARALLEL_BATCH_SIZE);
+      if (par.batch [i] == NULL) err = 2;
+    }
+  } else if (st.st_size > 0) {
+    par.map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (par.map == MAP_FAILED) {
+      par.map = NULL;
+      err     = 1;
+    } else {
+      par.map_size  = st.st_size;
+      par.nb_chunks = 1;                                      //  every chunk start + margin in the file
+      if (par.map_size > FASTER_PARALLEL_SYNC_MARGIN) {
+        par.nb_chunks = (par.map_size - FASTER_PARALLEL_SYNC_MARGIN + FASTER_PARALLEL_CHUNK_SIZE - 1) / FASTER_PARALLEL_CHUNK_SIZE;
+      }
+      par.starts    = (size_t*) malloc (par.nb_chunks * sizeof (size_t));
+      par.ends      = (size_t*) malloc (par.nb_chunks * sizeof (size_t));
+      if (par.starts == NULL || par.ends == NULL) err = 2;
+      if (nb_threads > (int) par.nb_chunks) nb_threads = par.nb_chunks;
+#ifdef MADV_HUGEPAGE
+      madvise (par.map, par.map_size, MADV_HUGEPAGE);
+#endif
+    }
+  }
+  if (fd >= 0) close (fd);
+  workers = (faster_parallel_worker_t*) calloc (nb_threads, sizeof (faster_parallel_worker_t));
+  if (workers == NULL) err = 2;
+  if (!err) {
+    pthread_mutex_init (&par.lock,    NULL);
+    pthread_cond_init  (&par.filled,  NULL);
+    pthread_cond_init  (&par.emptied, NULL);
+    for (i=0; i<nb_threads; i++) {
+      workers [i].par     = &par;
+      workers [i].context = init != NULL ? init (i, user) : NULL;
+    }
+    for (i=0; i<nb_threads; i++) {
+      if (pthread_create (&workers [i].thread, NULL, is_gz ? faster_parallel_batch_worker
+                                                           : faster_parallel_map_worker, &workers [i]) != 0) break;
+    }
+    nb_started = i;
+    if (nb_started == 0) {                                    //  no thread at all : read here
+      if (is_gz) err = faster_parallel_serial (&par, filename, workers [0].context);
+      else       faster_parallel_map_worker (&workers [0]);
+    } else if (is_gz) {
+      err = faster_parallel_inflate (&par, filename);
+      pthread_mutex_lock     (&par.lock);
+      par.eof = 1;
+      pthread_cond_broadcast (&par.filled);
+      pthread_mutex_unlock   (&par.lock);
+    }
+    for (i=0; i<nb_started; i++) pthread_join (workers [i].thread, NULL);
+    for (c=1; c<par.nb_chunks; c++) {
+      if (par.ends [c-1] != par.starts [c]) err = 3;
+    }
+    for (i=0; i<nb_threads; i++) {
+      if (merge != NULL) merge (workers [i].context, user);
+    }
+    pthread_mutex_destroy (&par.lock);
+    pthread_cond_destroy  (&par.filled);
+    pthread_cond_destroy  (&par.emptied);
+  }
+  if (par.map != NULL) munmap (par.map, par.map_size);
+  for (i=0; par.batch != NULL && i<par.nb_batches; i++) free (par.batch [i]);
+  free (par.batch);
+  free (par.batch_len);
+  free (par.batch_state);
+  free (par.starts);
+  free (par.ends);
+  free (workers);
+  return err;
+}
+
+
 //  FILE WRITER
+//
+//  Raw : one fwrite per data.
+//  Compressed : the data are copied to frames of FASTER_WRITER_FRAME_SIZE
+//  bytes (cut between data), compressed by a pool of threads and written
+//  in order by the caller. A ring of 2 frames per thread bounds the memory.
+//    - gzip : each frame is an independent gzip member (gzopen readers read
+//      the concatenation), its header carries an extra field 'FA' with the
+//      uncompressed and member sizes (findex seeks to the frames without
+//      inflating the file),
+//    - zstd (if built with libzstd) : one zstd frame per frame and the seek
+//      table of the zstd seekable format at the end of the file.
+
+#define FASTER_WRITER_FRAME_SIZE  1048576
+#define FASTER_WRITER_GZ_HEADER   24                     //  10 + xlen (2) + 'F' 'A' len (4) + sizes (8)
+#define FASTER_WRITER_GZ_TRAILER  8
+#define FASTER_WRITER_ZSTD_SKIP   0x184D2A5E             //  skippable frame (seek table)
+#define FASTER_WRITER_ZSTD_SEEK   0x8F92EAB1             //  seekable format footer
+
+enum { FRAME_FREE, FRAME_FILLED, FRAME_DONE, FRAME_ERROR };
+
+typedef struct faster_writer_frame {
+  unsigned char*   in;
+  size_t           in_len;
+  unsigned char*   out;
+  size_t           out_len;
+  int              state;
+} faster_writer_frame;
 
 typedef struct faster_file_writer_t {
-  FILE *file;
+  FILE                *file;
+  int                  format;
+  int                  level;
+  int                  error;
+  //  compression pool
+  int                  nb_threads;
+  pthread_t           *threads;
+  int                  nb_frames;
+  faster_writer_frame *frames;
+  size_t               out_size;
+  unsigned long long   nb_filled;                  //  frames given to the pool
+  unsigned long long   nb_taken;                   //  frames taken by a thread
+  unsigned long long   nb_written;                 //  frames written to the file
+  int                  stop;
+  pthread_mutex_t      lock;
+  pthread_cond_t       todo;
+  pthread_cond_t       done;
+  //  zstd seek table (compressed, uncompressed sizes)
+  unsigned int        *seek;
+  unsigned long long   seek_max;
 } faster_file_writer_t;
 
 
-faster_file_writer_p  faster_file_writer_open (const char *filename) {
+static void faster_writer_le32 (unsigned char* p, unsigned int v) {
+  p [0] = v;
+  p [1] = v >> 8;
+  p [2] = v >> 16;
+  p [3] = v >> 24;
+}
+
+
+static int faster_writer_gzip_frame (faster_writer_frame* frame, size_t out_size, int level) {
+  z_stream       strm;
+  unsigned char* h = frame->out;
+  unsigned char* t;
+  size_t         member;
+  int            ret;
+  memset (&strm, 0, sizeof (strm));
+  if (deflateInit2 (&strm, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) return 2;   //  raw deflate
+  strm.next_in   = frame->in;
+  strm.avail_in  = frame->in_len;
+  strm.next_out  = frame->out + FASTER_WRITER_GZ_HEADER;
+  strm.avail_out = out_size - FASTER_WRITER_GZ_HEADER - FASTER_WRITER_GZ_TRAILER;
+  ret = deflate (&strm, Z_FINISH);
+  deflateEnd (&strm);
+  if (ret != Z_STREAM_END) return 2;
+  member = FASTER_WRITER_GZ_HEADER + strm.total_out + FASTER_WRITER_GZ_TRAILER;
+  memset (h, 0, FASTER_WRITER_GZ_HEADER);
+  h [0]  = 0x1f;                                           //  magic, deflate, FEXTRA
+  h [1]  = 0x8b;
+  h [2]  = 8;
+  h [3]  = 4;
+  h [9]  = 255;                                            //  OS unknown
+  h [10] = 12;                                             //  xlen
+  h [12] = 'F';
+  h [13] = 'A';
+  h [14] = 8;
+  faster_writer_le32 (h + 16, frame->in_len);
+  faster_writer_le32 (h + 20, member);
+  t = frame->out + member - FASTER_WRITER_GZ_TRAILER;
+  faster_writer_le32 (t,     crc32 (crc32 (0L, Z_NULL, 0), frame->in, frame->in_len));
+  faster_writer_le32 (t + 4, frame->in_len);
+  frame->out_len = member;
+  return 0;
+}
+
+
+static int faster_writer_compress_frame (faster_file_writer_t* ffw, faster_writer_frame* frame) {
+#ifdef FASTER_WITH_ZSTD
+  size_t n;
+  if (ffw->format == FASTER_WRITER_ZSTD) {
+    n = ZSTD_compress (frame->out, ffw->out_size, frame->in, frame->in_len, ffw->level);
+    if (ZSTD_isError (n)) return 2;
+    frame->out_len = n;
+    return 0;
+  }
+#endif
+  return faster_writer_gzip_frame (frame, ffw->out_size, ffw->level);
+}
+
+
+static void* faster_file_writer_compress (void* arg) {
+  faster_file_writer_t* ffw = (faster_file_writer_t*) arg;
+  faster_writer_frame*  frame;
+  int                   err;
+  pthread_mutex_lock (&ffw->lock);
+  while (1) {
+    while (ffw->nb_taken == ffw->nb_filled && !ffw->stop) pthread_cond_wait (&ffw->todo, &ffw->lock);
+    if (ffw->nb_taken == ffw->nb_filled) break;            //  stopped, nothing left
+    frame = &ffw->frames [ffw->nb_taken % ffw->nb_frames];
+    ffw->nb_taken += 1;
+    pthread_mutex_unlock (&ffw->lock);
+    err = faster_writer_compress_frame (ffw, frame);
+    pthread_mutex_lock (&ffw->lock);
+    frame->state = err ? FRAME_ERROR : FRAME_DONE;
+    pthread_cond_broadcast (&ffw->done);
+  }
+  pthread_mutex_unlock (&ffw->lock);
+  return NULL;
+}
+
+
+static void faster_file_writer_write_frame (faster_file_writer_t* ffw) {   //  oldest frame of the pool
+  faster_writer_frame* frame = &ffw->frames [ffw->nb_written % ffw->nb_frames];
+  unsigned int*        seek;
+  unsigned long long   seek_max;
+  pthread_mutex_lock (&ffw->lock);
+  while (frame->state == FRAME_FILLED) pthread_cond_wait (&ffw->done, &ffw->lock);
+  pthread_mutex_unlock (&ffw->lock);
+  if (ffw->error) {
+    //  after the first error : frame dropped, no gap in the written stream
+  } else if (frame->state == FRAME_ERROR) {
+    ffw->error = 2;
+  } else if (fwrite (frame->out, frame->out_len, 1, ffw->file) != 1) {
+    ffw->error = 1;
+  }
+  if (ffw->format == FASTER_WRITER_ZSTD && !ffw->error) {
+    if (ffw->nb_written == ffw->seek_max) {
+      seek_max = ffw->seek_max == 0 ? 1024 : 2 * ffw->seek_max;
+      seek     = (unsigned int*) realloc (ffw->seek, 2 * seek_max * sizeof (unsigned int));
+      if (seek == NULL) {
+        ffw->error = 2;
+      } else {
+        ffw->seek     = seek;
+        ffw->seek_max = seek_max;
+      }
+    }
+    if (ffw->nb_written < ffw->seek_max) {
+      ffw->seek [2 * ffw->nb_written]     = frame->out_len;
+      ffw->seek [2 * ffw->nb_written + 1] = frame->in_len;
+    }
+  }
+  frame->in_len   = 0;
+  frame->state    = FRAME_FREE;
+  ffw->nb_written += 1;
+}
+
+
+static void faster_file_writer_submit (faster_file_writer_t* ffw) {       //  current frame to the pool
+  pthread_mutex_lock (&ffw->lock);
+  ffw->frames [ffw->nb_filled % ffw->nb_frames].state = FRAME_FILLED;
+  ffw->nb_filled += 1;
+  pthread_cond_signal (&ffw->todo);
+  pthread_mutex_unlock (&ffw->lock);
+  if (ffw->nb_filled - ffw->nb_written == (unsigned long long) ffw->nb_frames) {
+    faster_file_writer_write_frame (ffw);                  //  ring full : next frame freed
+  }
+}
+
+
+static int faster_file_writer_write_seek_table (faster_file_writer_t* ffw) {
+  unsigned char      b [9];
+  unsigned long long i;
+  faster_writer_le32 (b,     FASTER_WRITER_ZSTD_SKIP);
+  faster_writer_le32 (b + 4, 8 * ffw->nb_written + 9);
+  if (fwrite (b, 8, 1, ffw->file) != 1) return 1;
+  for (i=0; i<ffw->nb_written; i++) {
+    faster_writer_le32 (b,     ffw->seek [2 * i]);
+    faster_writer_le32 (b + 4, ffw->seek [2 * i + 1]);
+    if (fwrite (b, 8, 1, ffw->file) != 1) return 1;
+  }
+  faster_writer_le32 (b, ffw->nb_written);
+  b [4] = 0;                                               //  descriptor : no checksums
+  faster_writer_le32 (b + 5, FASTER_WRITER_ZSTD_SEEK);
+  return fwrite (b, 9, 1, ffw->file) != 1;
+}
+
+
+static void faster_file_writer_free (faster_file_writer_t* ffw) {
+  int i;
+  for (i=0; ffw->frames != NULL && i<ffw->nb_frames; i++) {
+    free (ffw->frames [i].in);
+    free (ffw->frames [i].out);
+  }
+  free (ffw->frames);
+  free (ffw->threads);
+  free (ffw->seek);
+  free (ffw);
+}
+
+
+faster_file_writer_p  faster_file_writer_open_compressed (const char *filename, int format, int level, int nb_threads) {
   faster_file_writer_t *ffw;
-  ffw       = (faster_file_writer_t*) malloc (sizeof (faster_file_writer_t));
+  int                   i;
+#ifndef FASTER_WITH_ZSTD
+  if (format == FASTER_WRITER_ZSTD) return NULL;
+#endif
+  ffw = (faster_file_writer_t*) calloc (1, sizeof (faster_file_writer_t));
+  if (ffw == NULL) return NULL;
+  ffw->format = format;
+  ffw->level  = level;
+  if (format != FASTER_WRITER_RAW) {
+    if (nb_threads <= 0) nb_threads = sysconf (_SC_NPROCESSORS_ONLN);
+    if (nb_threads <= 0) nb_threads = 1;
+    ffw->nb_frames = 2 * nb_threads;
+    ffw->out_size  = compressBound (FASTER_WRITER_FRAME_SIZE) + FASTER_WRITER_GZ_HEADER + FASTER_WRITER_GZ_TRAILER;
+#ifdef FASTER_WITH_ZSTD
+    if (format == FASTER_WRITER_ZSTD) ffw->out_size = ZSTD_compressBound (FASTER_WRITER_FRAME_SIZE);
+#endif
+    ffw->frames  = (faster_writer_frame*) calloc (ffw->nb_frames, sizeof (faster_writer_frame));
+    ffw->threads = (pthread_t*)           calloc (nb_threads,     sizeof (pthread_t));
+    for (i=0; ffw->frames != NULL && i<ffw->nb_frames; i++) {
+      ffw->frames [i].in  = (unsigned char*) malloc (FASTER_WRITER_FRAME_SIZE);
+      ffw->frames [i].out = (unsigned char*) malloc (ffw->out_size);
+      if (ffw->frames [i].in == NULL || ffw->frames [i].out == NULL) break;
+    }
+    if (ffw->frames == NULL || ffw->threads == NULL || i < ffw->nb_frames) {
+      faster_file_writer_free (ffw);
+      return NULL;
+    }
+  }
   ffw->file = fopen (filename, "w");
   if (ffw->file == NULL) {
-    free (ffw);
+    faster_file_writer_free (ffw);
     return NULL;
   }
+  if (format != FASTER_WRITER_RAW) {
+    pthread_mutex_init (&ffw->lock, NULL);
+    pthread_cond_init  (&ffw->todo, NULL);
+    pthread_cond_init  (&ffw->done, NULL);
+    for (i=0; i<nb_threads; i++) {
+      if (pthread_create (&ffw->threads [i], NULL, faster_file_writer_compress, ffw) != 0) break;
+    }
+    ffw->nb_threads = i;
+    if (i == 0) {                                          //  no thread at all
+      pthread_mutex_destroy (&ffw->lock);
+      pthread_cond_destroy  (&ffw->todo);
+      pthread_cond_destroy  (&ffw->done);
+      fclose (ffw->file);
+      faster_file_writer_free (ffw);
+      return NULL;
+    }
+  }
   return ffw;
 }
 
 
-void faster_file_writer_close (faster_file_writer_p writer) {
+faster_file_writer_p  faster_file_writer_open (const char *filename) {
+  size_t len = strlen (filename);
+  if (len > 3 && strcmp (filename + len - 3, ".gz") == 0) {
+    return faster_file_writer_open_compressed (filename, FASTER_WRITER_GZIP, FASTER_WRITER_DEFAULT_LEVEL, 0);
+  }
+#ifdef FASTER_WITH_ZSTD
+  if (len > 4 && strcmp (filename + len - 4, ".zst") == 0) {
+    return faster_file_writer_open_compressed (filename, FASTER_WRITER_ZSTD, FASTER_WRITER_DEFAULT_LEVEL, 0);
+  }
+#endif
+  return faster_file_writer_open_compressed (filename, FASTER_WRITER_RAW, 0, 0);
+}
+
+
+int faster_file_writer_close (faster_file_writer_p writer) {
   faster_file_writer_t *ffw = (faster_file_writer_t*) writer;
-  if (writer) {
-    if (ffw->file != NULL) fclose (ffw->file);
-    free (ffw);
-    writer = NULL;
+  int                   err;
+  int                   i;
+  if (writer == NULL) return 0;
+  if (ffw->format != FASTER_WRITER_RAW) {
+    if (ffw->frames [ffw->nb_filled % ffw->nb_frames].in_len > 0) faster_file_writer_submit (ffw);
+    while (ffw->nb_written < ffw->nb_filled) faster_file_writer_write_frame (ffw);
+    pthread_mutex_lock     (&ffw->lock);
+    ffw->stop = 1;
+    pthread_cond_broadcast (&ffw->todo);
+    pthread_mutex_unlock   (&ffw->lock);
+    for (i=0; i<ffw->nb_threads; i++) pthread_join (ffw->threads [i], NULL);
+    pthread_mutex_destroy (&ffw->lock);
+    pthread_cond_destroy  (&ffw->todo);
+    pthread_cond_destroy  (&ffw->done);
+    if (ffw->format == FASTER_WRITER_ZSTD && !ffw->error && faster_file_writer_write_seek_table (ffw)) ffw->error = 1;
   }
+  if (fclose (ffw->file) != 0 && !ffw->error) ffw->error = 1;
+  err = ffw->error;
+  faster_file_writer_free (ffw);
+  return err;
 }
 
 
 void faster_file_writer_next (const faster_file_writer_p writer, const faster_data_p data) {
   faster_file_writer_t *ffw    = (faster_file_writer_t*) writer;
   size_t                width  = sizeof (faster_data_header_t) + faster_data_load_size (data);
-  fwrite (data, width, 1, ffw->file);
+  faster_writer_frame  *frame;
+  if (ffw->error) return;                                  //  nothing written after the first error
+  if (ffw->format == FASTER_WRITER_RAW) {
+    if (fwrite (data, width, 1, ffw->file) != 1) ffw->error = 1;
+    return;
+  }
+  frame = &ffw->frames [ffw->nb_filled % ffw->nb_frames];
+  if (frame->in_len + width > FASTER_WRITER_FRAME_SIZE) {
+    faster_file_writer_submit (ffw);
+    frame = &ffw->frames [ffw->nb_filled % ffw->nb_frames];
+  }
+  memcpy (frame->in + frame->in_len, data, width);
+  frame->in_len += width;
+}
+
+
+int faster_file_writer_error (const faster_file_writer_p writer) {
+  return ((faster_file_writer_t*) writer)->error;
 }
 
 
@@ -0,0 +1,312 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "fasterac/fcoinc.h"
+#include "fasterac/group.h"
+
+
+//----  private  -----------------------------------//
+
+#define FCOINC_NB_LABELS     65536
+#define FCOINC_MIN_SLOTS     1024
+#define FCOINC_DATA_HEADER   12
+
+typedef struct fcoinc_slot {
+  fcoinc_hit     hit;
+  unsigned char* buf;                                        //  data copy buffer
+  size_t         capacity;
+} fcoinc_slot;
+
+typedef struct fcoinc_builder {
+  long long          window;
+  long long          delay;
+  int                min_fold;
+  fcoinc_group_fn    callback;
+  void*              user;
+  long long*         offsets;                                //  per label
+  long long          min_offset;
+  long long          tolerance;                              //  input disorder
+  fcoinc_slot*       slots;                                  //  ring buffer
+  unsigned long long mask;
+  unsigned long long open;                                   //  oldest pending hit (absolute)
+  unsigned long long tail;                                   //  next free slot (absolute)
+  unsigned long long dptr;                                   //  delayed window scan
+  long long          closed;                                 //  hits before are late
+  long long          last_raw;                               //  latest input clock
+  fcoinc_hit*        group;                                  //  contiguous copy of a group
+  int                group_max;
+  unsigned long long nb_pushed;
+  fcoinc_stats       stats;
+} fcoinc_builder;
+
+
+static int fcoinc_grow (fcoinc_builder* fc) {
+  unsigned long long n    = fc->mask + 1;
+  fcoinc_slot*       news = (fcoinc_slot*) calloc (2 * n, sizeof (fcoinc_slot));
+  unsigned long long i;
+  if (news == NULL) return 2;
+  for (i = fc->open; i < fc->tail; i++) {                    //  the ring is full
+    news [i & (2 * n - 1)] = fc->slots [i & fc->mask];
+  }
+  free (fc->slots);
+  fc->slots = news;
+  fc->mask  = 2 * n - 1;
+  return 0;
+}
+
+
+static int fcoinc_emit (fcoinc_builder* fc, unsigned long long from, unsigned long long to) {
+  int n = (int) (to - from);
+  int k;
+  fcoinc_hit* group;
+  if (n > fc->group_max) {
+    group = (fcoinc_hit*) realloc (fc->group, 2 * n * sizeof (fcoinc_hit));
+    if (group == NULL) return 2;
+    fc->group     = group;
+    fc->group_max = 2 * n;
+  }
+  for (k = 0; k < n; k++) fc->group [k] = fc->slots [(from + k) & fc->mask].hit;
+  fc->callback (fc->group, n, fc->user);
+  return 0;
+}
+
+
+static int fcoinc_window (fcoinc_builder* fc) {             //  window of the oldest pending hit
+  long long          t0    = (long long) fc->slots [fc->open & fc->mask].hit.clock_ns;
+  unsigned long long end   = fc->open;
+  unsigned long long k;
+  int                count;
+  while (end < fc->tail && (long long) fc->slots [end & fc->mask].hit.clock_ns < t0 + fc->window) end++;
+  fc->stats.nb_windows++;
+  if (fc->delay > 0) {                                       //  accidentals
+    if (fc->dptr < end) fc->dptr = end;
+    while (fc->dptr < fc->tail && (long long) fc->slots [fc->dptr & fc->mask].hit.clock_ns < t0 + fc->delay) fc->dptr++;
+    count = 0;
+    for (k = fc->dptr; k < fc->tail && (long long) fc->slots [k & fc->mask].hit.clock_ns < t0 + fc->delay + fc->window; k++) count++;
+    if (count >= (fc->min_fold > 1 ? fc->min_fold - 1 : 1)) fc->stats.nb_accidentals++;
+  }
+  if ((int) (end - fc->open) >= fc->min_fold) {              //  group : its hits are consumed
+    if (fc->callback != NULL && fcoinc_emit (fc, fc->open, end) != 0) return 2;
+    fc->stats.nb_groups++;
+    fc->closed = t0 + fc->window;
+    fc->open   = end;
+  } else {                                                   //  only the opening hit is dropped
+    if (fc->closed < t0) fc->closed = t0;
+    fc->open++;
+  }
+  return 0;
+}
+
+
+static int fcoinc_process (fcoinc_builder* fc, int flush) {
+  long long horizon = fc->delay > 0 ? fc->delay + fc->window : fc->window;
+  while (fc->open < fc->tail) {
+    if (!flush && fc->last_raw + fc->min_offset - fc->tolerance < (long long) fc->slots [fc->open & fc->mask].hit.clock_ns + horizon) break;
+    if (fcoinc_window (fc) != 0) return 2;
+  }
+  return 0;
+}
+
+
+static int fcoinc_insert (fcoinc_builder* fc, long long raw, unsigned short label, unsigned long long index,
+                          faster_data_p data) {
+  long long          clock = raw + fc->offsets [label];
+  unsigned long long pos;
+  fcoinc_slot*       s;
+  fcoinc_slot        tmp;
+  size_t             size;
+  unsigned char*     buf;
+  if (clock < 0) clock = 0;
+  fc->stats.nb_hits++;
+  if (raw > fc->last_raw) fc->last_raw = raw;
+  if (clock < fc->closed) {                                  //  its window is already closed
+    fc->stats.nb_late++;
+    return 0;
+  }
+  if (fc->tail - fc->open > fc->mask && fcoinc_grow (fc) != 0) return 2;
+  s = &fc->slots [fc->tail & fc->mask];
+  s->hit.clock_ns = (unsigned long long) clock;
+  s->hit.label    = label;
+  s->hit.index    = index;
+  s->hit.data     = NULL;
+  if (data != NULL) {                                        //  data copy
+    size = FCOINC_DATA_HEADER + faster_data_load_size (data);
+    if (size > s->capacity) {
+      buf = (unsigned char*) realloc (s->buf, size);
+      if (buf == NULL) return 2;
+      s->buf      = buf;
+      s->capacity = size;
+    }
+    memcpy (s->buf, data, size);
+    s->hit.data = s->buf;
+  }
+  pos = fc->tail;                                            //  time order
+  while (pos > fc->open && (long long) fc->slots [(pos - 1) & fc->mask].hit.clock_ns > clock) {
+    tmp                              = fc->slots [pos & fc->mask];
+    fc->slots [pos & fc->mask]       = fc->slots [(pos - 1) & fc->mask];
+    fc->slots [(pos - 1) & fc->mask] = tmp;
+    pos--;
+  }
+  if (pos < fc->dptr) fc->dptr++;
+  fc->tail++;
+  if (fc->stats.nb_hits - fc->stats.nb_late == 1 || (unsigned long long) clock < fc->stats.first_ns) fc->stats.first_ns = clock;
+  if ((unsigned long long) clock > fc->stats.last_ns) fc->stats.last_ns = clock;
+  return fcoinc_process (fc, 0);
+}
+
+
+static int fcoinc_push_data (fcoinc_builder* fc, faster_data_p data) {
+  group_iter    it;
+  faster_data_p inner;
+  int           err;
+  if (faster_data_type_alias (data) == GROUP_TYPE_ALIAS) {   //  flattened group (stops at a truncated data)
+    group_iter_init (&it, data);
+    while ((inner = group_iter_next (&it)) != NULL) {
+      err = fcoinc_push_data (fc, inner);
+      if (err) return err;
+    }
+    return 0;
+  }
+  return fcoinc_insert (fc, (long long) faster_data_clock_ns (data), faster_data_label (data), fc->nb_pushed++, data);
+}
+
+
+typedef struct fcoinc_numbering {
+  long long* group_of_hit;
+  long long  nb_groups;
+} fcoinc_numbering;
+
+
+static void fcoinc_columns_group (const fcoinc_hit* hits, int nb_hits, void* user) {
+  fcoinc_numbering* num = (fcoinc_numbering*) user;
+  int               k;
+  for (k = 0; k < nb_hits; k++) num->group_of_hit [hits [k].index] = num->nb_groups;
+  num->nb_groups++;
+}
+
+
+//--------------------------------------------------//
+
+fcoinc_p fcoinc_open (unsigned long long window_ns, int min_fold, fcoinc_group_fn callback, void* user) {
+  fcoinc_builder* fc = (fcoinc_builder*) calloc (1, sizeof (fcoinc_builder));
+  if (fc == NULL) return NULL;
+  fc->offsets = (long long*)   calloc (FCOINC_NB_LABELS, sizeof (long long));
+  fc->slots   = (fcoinc_slot*) calloc (FCOINC_MIN_SLOTS, sizeof (fcoinc_slot));
+  if (fc->offsets == NULL || fc->slots == NULL) {
+    free (fc->offsets);
+    free (fc->slots);
+    free (fc);
+    return NULL;
+  }
+  fc->window   = (long long) window_ns;
+  fc->min_fold = min_fold < 1 ? 1 : min_fold;
+  fc->callback = callback;
+  fc->user     = user;
+  fc->mask     = FCOINC_MIN_SLOTS - 1;
+  return (fcoinc_p) fc;
+}
+
+
+void fcoinc_set_offset (fcoinc_p fc, unsigned short label, long long offset_ns) {
+  fcoinc_builder* b = (fcoinc_builder*) fc;
+  b->offsets [label] = offset_ns;
+  if (offset_ns < b->min_offset) b->min_offset = offset_ns;
+}
+
+
+void fcoinc_set_delay (fcoinc_p fc, unsigned long long delay_ns) {
+  fcoinc_builder* b = (fcoinc_builder*) fc;
+  b->delay = (long long) delay_ns;
+  if (b->delay > 0 && b->delay < b->window) b->delay = b->window;
+}
+
+
+void fcoinc_set_tolerance (fcoinc_p fc, unsigned long long tolerance_ns) {
+  ((fcoinc_builder*) fc)->tolerance = (long long) tolerance_ns;
+}
+
+
+int fcoinc_push (fcoinc_p fc, faster_data_p data) {
+  return fcoinc_push_data ((fcoinc_builder*) fc, data);
+}
+
+
+int fcoinc_push_hit (fcoinc_p fc, unsigned long long clock_ns, unsigned short label, unsigned long long index) {
+  return fcoinc_insert ((fcoinc_builder*) fc, (long long) clock_ns, label, index, NULL);
+}
+
+
+int fcoinc_flush (fcoinc_p fc) {
+  return fcoinc_process ((fcoinc_builder*) fc, 1);
+}
+
+
+void fcoinc_get_stats (fcoinc_p fc, fcoinc_stats* stats) {
+  fcoinc_builder* b = (fcoinc_builder*) fc;
+  double          duration;
+  *stats   = b->stats;
+  duration = 1e-9 * (stats->last_ns - stats->first_ns);
+  stats->group_rate      = duration > 0 ? stats->nb_groups      / duration : 0;
+  stats->accidental_rate = duration > 0 ? stats->nb_accidentals / duration : 0;
+}
+
+
+void fcoinc_close (fcoinc_p fc) {
+  fcoinc_builder*    b = (fcoinc_builder*) fc;
+  unsigned long long i;
+  if (b == NULL) return;
+  for (i = 0; i <= b->mask; i++) free (b->slots [i].buf);
+  free (b->slots);
+  free (b->offsets);
+  free (b->group);
+  free (b);
+}
+
+
+int fcoinc_columns (const fcolumns* col, unsigned long long window_ns, int min_fold,
+                    const long long* offsets, unsigned long long delay_ns,
+                    long long* group_of_hit, fcoinc_stats* stats) {
+  fcoinc_numbering   num;
+  fcoinc_p           fc;
+  unsigned long long i;
+  unsigned long long latest    = 0;
+  unsigned long long tolerance = 0;
+  unsigned long long span      = 0;                          //  largest clock span of a group
+  unsigned long long gmin      = 0;
+  unsigned long long gmax      = 0;
+  int                label;
+  int                err = 0;
+  for (i = 0; i < col->nb_data; i++) group_of_hit [i] = -1;
+  num.group_of_hit = group_of_hit;
+  num.nb_groups    = 0;
+  fc = fcoinc_open (window_ns, min_fold, fcoinc_columns_group, &num);
+  if (fc == NULL) return 2;
+  if (offsets != NULL) {
+    for (label = 0; label < FCOINC_NB_LABELS; label++) {
+      if (offsets [label] != 0) fcoinc_set_offset (fc, label, offsets [label]);
+    }
+  }
+  fcoinc_set_delay (fc, delay_ns);
+  for (i = 0; i < col->nb_data; i++) {                       //  disorder of the flattened groups
+    if (col->clock_ns [i] > latest) latest = col->clock_ns [i];
+    else if (latest - col->clock_ns [i] > tolerance) tolerance = latest - col->clock_ns [i];
+    if (col->flags [i] & FCOLUMNS_GROUP_START) {
+      gmin = col->clock_ns [i];
+      gmax = col->clock_ns [i];
+    } else if (col->flags [i] & FCOLUMNS_IN_GROUP) {
+      if (col->clock_ns [i] < gmin) gmin = col->clock_ns [i];
+      if (col->clock_ns [i] > gmax) gmax = col->clock_ns [i];
+    }
+    if (gmax - gmin > span) span = gmax - gmin;
+  }
+  if (tolerance > span) tolerance = span;                    //  unsorted input : late hits, not a whole file ring
+  fcoinc_set_tolerance (fc, tolerance);
+  for (i = 0; !err && i < col->nb_data; i++) {
+    err = fcoinc_push_hit (fc, col->clock_ns [i], col->label [i], i);
+  }
+  if (!err) err = fcoinc_flush (fc);
+  if (!err && stats != NULL) fcoinc_get_stats (fc, stats);
+  fcoinc_close (fc);
+  return err;
+}
@@ -0,0 +1,193 @@
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "fasterac/fcolumns.h"
+#include "fasterac/qdc.h"
+#include "fasterac/spectro.h"
+#include "fasterac/group.h"
+
+
+//----  private  -----------------------------------//
+
+#define FCOLUMNS_MAGIC       "FCOL"
+#define FCOLUMNS_VERSION     1
+#define FCOLUMNS_ALIGN       64
+
+typedef struct fcolumns_header {
+  char               magic [4];
+  unsigned int       version;
+  unsigned long long nb_data;
+  unsigned long long label_pos;
+  unsigned long long clock_pos;
+  unsigned long long q_pos;
+  unsigned long long flags_pos;
+  unsigned long long reserved [2];
+} fcolumns_header;
+  //  64 bytes, the columns follow
+
+
+static unsigned long long fcolumns_align (unsigned long long pos) {
+  return (pos + FCOLUMNS_ALIGN - 1) / FCOLUMNS_ALIGN * FCOLUMNS_ALIGN;
+}
+
+
+static void fcolumns_layout (fcolumns_header* h, unsigned long long nb_data) {
+  memset (h, 0, sizeof (fcolumns_header));
+  memcpy (h->magic, FCOLUMNS_MAGIC, 4);
+  h->version   = FCOLUMNS_VERSION;
+  h->nb_data   = nb_data;
+  h->label_pos = sizeof (fcolumns_header);
+  h->clock_pos = fcolumns_align (h->label_pos + nb_data * sizeof (unsigned short));
+  h->q_pos     = fcolumns_align (h->clock_pos + nb_data * sizeof (unsigned long long));
+  h->flags_pos = fcolumns_align (h->q_pos     + nb_data * sizeof (int));
+}
+
+
+static int fcolumns_grow (fcolumns* col) {
+  unsigned long long max = col->max_data == 0 ? 65536 : 2 * col->max_data;
+  unsigned short*     label = (unsigned short*)     realloc (col->label,    max * sizeof (unsigned short));
+  unsigned long long* clock = (unsigned long long*) realloc (col->clock_ns, max * sizeof (unsigned long long));
+  int*                q     = (int*)                realloc (col->q,        max * sizeof (int));
+  unsigned char*      flags = (unsigned char*)      realloc (col->flags,    max * sizeof (unsigned char));
+  if (label != NULL) col->label    = label;
+  if (clock != NULL) col->clock_ns = clock;
+  if (q     != NULL) col->q        = q;
+  if (flags != NULL) col->flags    = flags;
+  if (label == NULL || clock == NULL || q == NULL || flags == NULL) return 2;
+  col->max_data = max;
+  return 0;
+}
+
+
+static int fcolumns_append (fcolumns* col, faster_data_p data, int in_group, int group_start) {
+  unsigned char  alias = faster_data_type_alias (data);
+  group_iter     it;
+  faster_data_p  inner;
+  unsigned long long n;
+  qdc_x1*        qdc;
+  crrc4_spectro* spectro;
+  int            err;
+  if (alias == GROUP_TYPE_ALIAS) {                           //  flattened group (stops at a truncated data)
+    group_iter_init (&it, data);
+    group_start = 1;
+    while ((inner = group_iter_next (&it)) != NULL) {
+      n   = col->nb_data;
+      err = fcolumns_append (col, inner, 1, group_start);
+      if (err) return err;
+      if (col->nb_data > n) group_start = 0;
+    }
+    return 0;
+  }
+  if (alias != QDC_X1_TYPE_ALIAS && alias != QDC_TDC_X1_TYPE_ALIAS && alias != CRRC4_SPECTRO_TYPE_ALIAS) return 0;
+  if (col->nb_data == col->max_data && fcolumns_grow (col) != 0) return 2;
+  n = col->nb_data;
+  col->label    [n] = faster_data_label    (data);
+  col->clock_ns [n] = faster_data_clock_ns (data);
+  col->flags    [n] = (in_group ? FCOLUMNS_IN_GROUP : 0) | (group_start ? FCOLUMNS_GROUP_START : 0);
+  if (alias == CRRC4_SPECTRO_TYPE_ALIAS) {
+    spectro        = (crrc4_spectro*) faster_data_load_p (data);
+    col->q     [n] = spectro->measure;
+    col->flags [n] |= (spectro->saturated ? FCOLUMNS_SATURATED : 0) | (spectro->pileup ? FCOLUMNS_PILEUP : 0);
+  } else {
+    qdc            = (qdc_x1*) faster_data_load_p (data);   //  q1 first in both qdc types
+    col->q     [n] = qdc->q1;
+    col->flags [n] |= qdc->q1_saturated ? FCOLUMNS_SATURATED : 0;
+  }
+  col->nb_data = n + 1;
+  return 0;
+}
+
+
+static int fcolumns_write_column (FILE* f, unsigned long long pos, const void* column, size_t size) {
+  if (fseeko (f, pos, SEEK_SET) != 0) return 1;
+  if (size > 0 && fwrite (column, size, 1, f) != 1) return 1;
+  return 0;
+}
+
+
+//--------------------------------------------------//
+
+int fcolumns_from_fast (const char* filename, fcolumns* col) {
+  faster_mmap_reader_p reader;
+  faster_data_p        data;
+  int                  err = 0;
+  memset (col, 0, sizeof (fcolumns));
+  reader = faster_mmap_reader_open (filename);
+  if (reader == NULL) return 1;
+  while (!err && (data = faster_mmap_reader_next (reader)) != NULL) {
+    err = fcolumns_append (col, data, 0, 0);
+  }
+  faster_mmap_reader_close (reader);
+  if (err) fcolumns_free (col);
+  return err;
+}
+
+
+int fcolumns_write (const fcolumns* col, const char* colname) {
+  fcolumns_header h;
+  FILE*           f;
+  int             err = 0;
+  f = fopen (colname, "wb");
+  if (f == NULL) return 1;
+  fcolumns_layout (&h, col->nb_data);
+  if (fwrite (&h, sizeof (h), 1, f) != 1) err = 1;
+  if (!err) err = fcolumns_write_column (f, h.label_pos, col->label,    col->nb_data * sizeof (unsigned short));
+  if (!err) err = fcolumns_write_column (f, h.clock_pos, col->clock_ns, col->nb_data * sizeof (unsigned long long));
+  if (!err) err = fcolumns_write_column (f, h.q_pos,     col->q,        col->nb_data * sizeof (int));
+  if (!err) err = fcolumns_write_column (f, h.flags_pos, col->flags,    col->nb_data * sizeof (unsigned char));
+  if (fclose (f) != 0) err = 1;
+  if (err) remove (colname);
+  return err;
+}
+
+
+int fcolumns_map (const char* colname, fcolumns* col) {
+  fcolumns_header h;
+  struct stat     st;
+  unsigned char*  map;
+  int             fd;
+  memset (col, 0, sizeof (fcolumns));
+  fd = open (colname, O_RDONLY);
+  if (fd < 0) return 1;
+  if (fstat (fd, &st) != 0) {
+    close (fd);
+    return 1;
+  }
+  if (pread (fd, &h, sizeof (h), 0) != sizeof (h) || memcmp (h.magic, FCOLUMNS_MAGIC, 4) != 0 ||
+      h.version != FCOLUMNS_VERSION || h.flags_pos + h.nb_data > (unsigned long long) st.st_size) {
+    close (fd);
+    return 3;
+  }
+  map = (unsigned char*) mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);                                                //  the mapping keeps the file
+  if (map == MAP_FAILED) return 1;
+  col->map      = map;
+  col->map_size = st.st_size;
+  col->nb_data  = h.nb_data;
+  col->max_data = h.nb_data;
+  col->label    = (unsigned short*)     (map + h.label_pos);
+  col->clock_ns = (unsigned long long*) (map + h.clock_pos);
+  col->q        = (int*)                (map + h.q_pos);
+  col->flags    = (unsigned char*)      (map + h.flags_pos);
+  return 0;
+}
+
+
+void fcolumns_free (fcolumns* col) {
+  if (col->map != NULL) {
+    munmap (col->map, col->map_size);
+  } else {
+    free (col->label);
+    free (col->clock_ns);
+    free (col->q);
+    free (col->flags);
+  }
+  memset (col, 0, sizeof (fcolumns));
+}
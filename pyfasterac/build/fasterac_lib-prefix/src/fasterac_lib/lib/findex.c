@@ -0,0 +1,693 @@
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include "fasterac/findex.h"
+#include "fasterac/group.h"
+
+
+//----  private  -----------------------------------//
+
+#define FINDEX_MAGIC         "FIDX"
+#define FINDEX_VERSION       3                       //  2 : entries of FINDEX_BLOCK_SIZE, types bitmap
+                                                     //  3 : size and mtime of the data file
+#define FINDEX_GZ_SPAN       1048576                 //  uncompressed bytes between inflate checkpoints
+#define FINDEX_CHUNK         65536                   //  file read / inflate chunk
+#define FINDEX_SKIP_MAX      1048576                 //  forward gap read through rather than seeked
+#define FINDEX_DATA_HEADER   12
+#define FINDEX_DATA_MAX      (FINDEX_DATA_HEADER + 65535)
+
+typedef struct findex_header {
+  char               magic [4];
+  unsigned int       version;
+  unsigned int       is_gz;
+  unsigned int       reserved;
+  unsigned long long nb_entries;
+  unsigned long long nb_points;
+  unsigned long long points_pos;
+  unsigned long long data_size;
+  long long          data_mtime;
+} findex_header;
+  //  Index file layout : header, entries, dictionaries (nb_points x 32KB), points.
+
+
+static int findex_is_gzip (FILE* f) {
+  unsigned char magic [2];
+  int           ok = fread (magic, 1, 2, f) == 2 && magic [0] == 0x1f && magic [1] == 0x8b;
+  rewind (f);
+  return ok;
+}
+
+
+static int findex_entry_overlaps (const findex_entry* e, unsigned long long from_ns, unsigned long long to_ns) {
+  return e->nb_data > 0 && e->max_ns >= from_ns && e->min_ns < to_ns;
+}
+
+
+static int findex_bitmaps_meet (const unsigned char* a, const unsigned char* b, int size) {
+  int i;
+  for (i=0; i<size; i++) {
+    if (a [i] & b [i]) return 1;
+  }
+  return 0;
+}
+
+
+static void findex_entry_add (findex_entry* e, faster_data_p data) {   //  data and its group to the bitmaps
+  group_ungroup ug;
+  faster_data_p leaf;
+  unsigned char label = faster_data_label (data) % 256;
+  unsigned char alias = faster_data_type_alias (data);
+  e->labels [label / 8] |= 1 << (label % 8);
+  e->types  [alias / 8] |= 1 << (alias % 8);
+  if (alias != GROUP_TYPE_ALIAS) return;
+  group_ungroup_init (&ug, data);
+  while ((leaf = group_ungroup_next (&ug, NULL)) != NULL) {
+    label = faster_data_label (leaf) % 256;
+    alias = faster_data_type_alias (leaf);
+    e->labels [label / 8] |= 1 << (label % 8);
+    e->types  [alias / 8] |= 1 << (alias % 8);
+  }
+}
+
+
+static int findex_leaf_match (const findex_predicate* pred, faster_data_p data) {
+  unsigned short label = faster_data_label (data);
+  unsigned char  alias = faster_data_type_alias (data);
+  return (pred->all_labels || (pred->labels [label / 8] & (1 << (label % 8)))) &&
+         (pred->all_types  || (pred->types  [alias / 8] & (1 << (alias % 8))));
+}
+
+
+//  Entries : one pass on the data with the file reader
+
+static int findex_build_entries (const char* filename, unsigned int nb_data_step, unsigned long long step_ns,
+                                 findex_entry** entries, unsigned long long* nb_entries) {
+  faster_file_reader_p reader;
+  faster_data_p        data;
+  findex_entry*        e      = NULL;
+  unsigned long long   max    = 0;
+  unsigned long long   n      = 0;
+  unsigned long long   offset = 0;
+  unsigned long long   first  = 0;
+  unsigned long long   bytes  = 0;
+  unsigned long long   clock;
+  unsigned int         size;
+  reader = faster_file_reader_open (filename);
+  if (reader == NULL) return 1;
+  while ((data = faster_file_reader_next (reader)) != NULL) {
+    clock = faster_data_clock_ns (data);
+    size  = FINDEX_DATA_HEADER + faster_data_load_size (data);
+    if (n == 0 || e [n-1].nb_data == nb_data_step || (step_ns > 0 && clock - first >= step_ns && clock > first) ||
+        bytes + size > FINDEX_BLOCK_SIZE) {
+      if (n == max) {                                      //  new entry
+        max = max == 0 ? 1024 : 2 * max;
+        e   = (findex_entry*) realloc (e, max * sizeof (findex_entry));
+        if (e == NULL) {
+          faster_file_reader_close (reader);
+          return 2;
+        }
+      }
+      memset (&e [n], 0, sizeof (findex_entry));
+      e [n].offset = offset;
+      e [n].min_ns = clock;
+      e [n].max_ns = clock;
+      first        = clock;
+      bytes        = 0;
+      n           += 1;
+    }
+    if (clock < e [n-1].min_ns) e [n-1].min_ns = clock;
+    if (clock > e [n-1].max_ns) e [n-1].max_ns = clock;
+    findex_entry_add (&e [n-1], data);
+    e [n-1].nb_data += 1;
+    bytes           += size;
+    offset          += size;
+  }
+  faster_file_reader_close (reader);
+  *entries    = e;
+  *nb_entries = n;
+  return 0;
+}
+
+
+//  Zero padding up to the end of file after the last gzip member
+
+static int findex_zero_tail (const unsigned char* p, unsigned int n, unsigned char* buf, FILE* in) {
+  size_t len;
+  while (1) {
+    while (n > 0) {
+      if (*p++ != 0) return 0;
+      n -= 1;
+    }
+    len = fread (buf, 1, FINDEX_CHUNK, in);
+    if (len == 0) return !ferror (in);
+    p = buf;
+    n = len;
+  }
+}
+
+
+//  Inflate checkpoints (zlib 'examples/zran.c') : the dictionaries are
+//  written to the index file as they come, the points are returned.
+//  A corrupt or truncated file is a file error.
+
+static int findex_build_points (FILE* in, FILE* out, findex_gz_point** points, unsigned long long* nb_points) {
+  z_stream           strm;
+  unsigned char*     input  = (unsigned char*) malloc (FINDEX_CHUNK);
+  unsigned char*     window = (unsigned char*) malloc (FINDEX_GZ_WINDOW_SIZE);
+  unsigned char*     dict   = (unsigned char*) malloc (FINDEX_GZ_WINDOW_SIZE);
+  findex_gz_point*   p      = NULL;
+  unsigned long long max    = 0;
+  unsigned long long n      = 0;
+  unsigned long long totin  = 0;
+  unsigned long long totout = 0;
+  unsigned long long last   = 0;
+  unsigned int       left;
+  int                ret    = Z_OK;
+  int                err    = 0;
+  int                done   = 0;
+  if (input == NULL || window == NULL || dict == NULL) err = 2;
+  memset (&strm, 0, sizeof (strm));
+  if (!err && inflateInit2 (&strm, 47) != Z_OK) err = 2;   //  zlib or gzip header
+  strm.avail_out = 0;
+  while (!err && !done) {
+    strm.avail_in = fread (input, 1, FINDEX_CHUNK, in);
+    strm.next_in  = input;
+    if (strm.avail_in == 0) break;
+    while (!err && !done && strm.avail_in != 0) {
+      if (ret == Z_STREAM_END) {                           //  next gzip member or zero padding
+        if (strm.next_in [0] == 0) {
+          if (findex_zero_tail (strm.next_in, strm.avail_in, input, in)) done = 1;
+          else                                                    err  = 1;
+          break;
+        }
+        if (inflateReset (&strm) != Z_OK) err = 3;
+        ret = Z_OK;
+      }
+      if (strm.avail_out == 0) {
+        strm.avail_out = FINDEX_GZ_WINDOW_SIZE;
+        strm.next_out  = window;
+      }
+      totin  += strm.avail_in;
+      totout += strm.avail_out;
+      ret     = inflate (&strm, Z_BLOCK);
+      totin  -= strm.avail_in;
+      totout -= strm.avail_out;
+      if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR) {
+        err = ret == Z_MEM_ERROR ? 2 : 1;
+        break;
+      }
+      if ((strm.data_type & 128) && !(strm.data_type & 64) && (n == 0 || totout - last > FINDEX_GZ_SPAN)) {
+        if (n == max) {
+          max = max == 0 ? 256 : 2 * max;
+          p   = (findex_gz_point*) realloc (p, max * sizeof (findex_gz_point));
+          if (p == NULL) {
+            err = 2;
+            break;
+          }
+        }
+        left = strm.avail_out;                             //  window is circular
+        if (left) memcpy (dict, window + FINDEX_GZ_WINDOW_SIZE - left, left);
+        if (left < FINDEX_GZ_WINDOW_SIZE) memcpy (dict + left, window, FINDEX_GZ_WINDOW_SIZE - left);
+        p [n].out        = totout;
+        p [n].in         = totin;
+        p [n].bits       = strm.data_type & 7;
+        p [n].reserved   = 0;
+        p [n].window_pos = ftello (out);
+        if (fwrite (dict, FINDEX_GZ_WINDOW_SIZE, 1, out) != 1) err = 1;
+        last = totout;
+        n   += 1;
+      }
+    }
+  }
+  if (ferror (in) || (!err && !done && ret != Z_STREAM_END)) err = 1;   //  read error or truncated
+  inflateEnd (&strm);
+  free (input);
+  free (window);
+  free (dict);
+  if (err) {
+    free (p);
+    return err;
+  }
+  *points    = p;
+  *nb_points = n;
+  return 0;
+}
+
+
+//  Frames of the compressed writer (faster_file_writer_open_compressed) :
+//  every gzip member has an extra field 'FA' with its uncompressed and
+//  member sizes, the members are the checkpoints (no dictionary needed).
+//  Return code : 0 when the whole file is made of such frames, 2 on
+//  memory error and 3 otherwise.
+
+static unsigned int findex_le32 (const unsigned char* p) {
+  return p [0] | (p [1] << 8) | (p [2] << 16) | ((unsigned int) p [3] << 24);
+}
+
+static int findex_build_frames (FILE* in, findex_gz_point** points, unsigned long long* nb_points) {
+  unsigned char      h [24];
+  findex_gz_point*   p      = NULL;
+  findex_gz_point*   q;
+  unsigned long long max    = 0;
+  unsigned long long n      = 0;
+  unsigned long long in_pos = 0;
+  unsigned long long out    = 0;
+  size_t             len;
+  unsigned int       member;
+  while ((len = fread (h, 1, sizeof (h), in)) > 0) {
+    if (len < sizeof (h) || h [0] != 0x1f || h [1] != 0x8b || h [2] != 8 || h [3] != 4 ||
+        h [10] != 12 || h [11] != 0 || h [12] != 'F' || h [13] != 'A' || h [14] != 8 || h [15] != 0) break;
+    member = findex_le32 (h + 20);
+    if (member <= sizeof (h)) break;
+    if (n == max) {
+      max = max == 0 ? 256 : 2 * max;
+      q   = (findex_gz_point*) realloc (p, max * sizeof (findex_gz_point));
+      if (q == NULL) {
+        free (p);
+        return 2;
+      }
+      p = q;
+    }
+    p [n].out        = out;
+    p [n].in         = in_pos;
+    p [n].bits       = -1;
+    p [n].reserved   = 0;
+    p [n].window_pos = 0;
+    n      += 1;
+    out    += findex_le32 (h + 16);
+    in_pos += member;
+    if (fseeko (in, in_pos, SEEK_SET) != 0) break;
+  }
+  if (len != 0 || n == 0 || ferror (in)) {                   //  not a framed file
+    free (p);
+    rewind (in);
+    return 3;
+  }
+  *points    = p;
+  *nb_points = n;
+  return 0;
+}
+
+
+//  Source of uncompressed bytes at any offset of the file
+
+typedef struct findex_source {
+  FILE*              file;
+  FILE*              idxfile;                      //  dictionaries (compressed files)
+  const findex*      idx;
+  z_stream           strm;
+  int                strm_on;
+  int                raw;                          //  raw deflate (started from a checkpoint)
+  int                stream_end;                   //  end of a gzip member reached
+  unsigned long long pos;                          //  uncompressed offset of out [0]
+  unsigned char      in  [FINDEX_CHUNK];
+  unsigned char      out [FINDEX_CHUNK];
+  size_t             out_pos;
+  size_t             out_len;
+} findex_source;
+
+
+static int findex_source_input (findex_source* src) {
+  if (src->strm.avail_in > 0) return 1;
+  src->strm.avail_in = fread (src->in, 1, FINDEX_CHUNK, src->file);
+  src->strm.next_in  = src->in;
+  return src->strm.avail_in > 0;
+}
+
+
+static int findex_source_fill (findex_source* src) {         //  0 at end of file or on error
+  int ret;
+  src->pos    += src->out_len;
+  src->out_pos = 0;
+  src->out_len = 0;
+  if (!src->idx->is_gz) {
+    src->out_len = fread (src->out, 1, FINDEX_CHUNK, src->file);
+    return src->out_len > 0;
+  }
+  if (!src->strm_on) return 0;
+  while (src->out_len == 0) {
+    if (src->stream_end) {                                   //  end of a gzip member
+      unsigned int trailer = src->raw ? 8 : 0;               //  raw deflate : skip crc & size
+      while (trailer > 0) {
+        if (!findex_source_input (src)) return 0;
+        while (trailer > 0 && src->strm.avail_in > 0) {
+          src->strm.next_in  += 1;
+          src->strm.avail_in -= 1;
+          trailer            -= 1;
+        }
+      }
+      if (!findex_source_input (src)) return 0;
+      if (inflateReset2 (&src->strm, src->raw ? 31 : 47) != Z_OK) return 0;
+      src->raw        = 0;
+      src->stream_end = 0;
+    }
+    if (!findex_source_input (src)) return 0;
+    src->strm.next_out  = src->out;
+    src->strm.avail_out = FINDEX_CHUNK;
+    ret = inflate (&src->strm, Z_NO_FLUSH);
+    if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) return 0;
+    src->out_len = FINDEX_CHUNK - src->strm.avail_out;
+    if (ret == Z_STREAM_END) src->stream_end = 1;
+  }
+  return 1;
+}
+
+
+static int findex_source_read (findex_source* src, unsigned char* dst, size_t n) {
+  size_t k;
+  while (n > 0) {
+    if (src->out_pos == src->out_len && !findex_source_fill (src)) return 0;
+    k = src->out_len - src->out_pos;
+    if (k > n) k = n;
+    if (dst != NULL) {
+      memcpy (dst, src->out + src->out_pos, k);
+      dst += k;
+    }
+    src->out_pos += k;
+    n            -= k;
+  }
+  return 1;
+}
+
+
+static int findex_source_seek (findex_source* src, unsigned long long offset) {
+  const findex*          idx = src->idx;
+  const findex_gz_point* pt  = NULL;
+  unsigned char          dict [FINDEX_GZ_WINDOW_SIZE];
+  unsigned long long     cur = src->pos + src->out_pos;
+  unsigned long long     lo, hi, mid;
+  int                    c;
+  if (offset >= cur && offset - cur <= FINDEX_SKIP_MAX && (src->strm_on || !idx->is_gz)) {
+    return findex_source_read (src, NULL, offset - cur);     //  close ahead : read through
+  }
+  src->out_pos = 0;
+  src->out_len = 0;
+  if (!idx->is_gz) {
+    src->pos = offset;
+    return fseeko (src->file, offset, SEEK_SET) == 0;
+  }
+  if (idx->nb_points > 0 && idx->points [0].out <= offset) { //  last checkpoint before offset
+    lo = 0;
+    hi = idx->nb_points - 1;
+    while (lo < hi) {
+      mid = (lo + hi + 1) / 2;
+      if (idx->points [mid].out <= offset) lo = mid;
+      else                                 hi = mid - 1;
+    }
+    pt = &idx->points [lo];
+  }
+  if (src->strm_on) inflateEnd (&src->strm);
+  memset (&src->strm, 0, sizeof (src->strm));
+  src->strm_on    = 0;
+  src->raw        = pt != NULL && pt->bits >= 0;
+  src->stream_end = 0;
+  if (pt == NULL || pt->bits < 0) {                          //  from the beginning or from a gzip member
+    if (inflateInit2 (&src->strm, 47) != Z_OK) return 0;
+    src->strm_on = 1;
+    src->pos     = pt != NULL ? pt->out : 0;
+    if (fseeko (src->file, pt != NULL ? pt->in : 0, SEEK_SET) != 0) return 0;
+  } else {
+    if (inflateInit2 (&src->strm, -15) != Z_OK) return 0;   //  raw deflate
+    src->strm_on = 1;
+    src->pos     = pt->out;
+    if (fseeko (src->file, pt->in - (pt->bits ? 1 : 0), SEEK_SET) != 0) return 0;
+    if (pt->bits) {
+      if ((c = getc (src->file)) == EOF) return 0;
+      inflatePrime (&src->strm, pt->bits, c >> (8 - pt->bits));
+    }
+    if (fseeko (src->idxfile, pt->window_pos, SEEK_SET) != 0 ||
+        fread  (dict, FINDEX_GZ_WINDOW_SIZE, 1, src->idxfile) != 1) return 0;
+    inflateSetDictionary (&src->strm, dict, FINDEX_GZ_WINDOW_SIZE);
+  }
+  return findex_source_read (src, NULL, offset - src->pos);
+}
+
+
+typedef struct findex_reader_t {
+  findex_source      src;
+  findex_predicate   pred;
+  unsigned char      labels [FINDEX_LABEL_BITMAP_SIZE];   //  selected labels folded as the entries bitmaps
+  unsigned long long entry;                        //  next entry
+  unsigned int       left;                         //  data left in the current entry
+  unsigned char      data [FINDEX_DATA_MAX];
+} findex_reader_t;
+
+
+//--------------------------------------------------//
+
+//  INDEX FILE
+
+int findex_build (const char* filename, const char* idxname, unsigned int nb_data_step, unsigned long long step_ns) {
+  findex_header      h;
+  findex_entry*      entries   = NULL;
+  findex_gz_point*   points    = NULL;
+  unsigned long long nb_points = 0;
+  struct stat        st;
+  FILE*              in;
+  FILE*              out;
+  int                err;
+  if (nb_data_step == 0) nb_data_step = 0xFFFFFFFF;
+  if (stat (filename, &st) != 0) return 1;                   //  before reading : a later change is seen
+  memset (&h, 0, sizeof (h));
+  memcpy (h.magic, FINDEX_MAGIC, 4);
+  h.version    = FINDEX_VERSION;
+  h.data_size  = st.st_size;
+  h.data_mtime = st.st_mtime;
+  err = findex_build_entries (filename, nb_data_step, step_ns, &entries, &h.nb_entries);
+  if (err) return err;
+  in  = fopen (filename, "rb");
+  out = fopen (idxname,  "wb");
+  if (in == NULL || out == NULL) {
+    if (in  != NULL) fclose (in);
+    if (out != NULL) fclose (out);
+    free (entries);
+    return 1;
+  }
+  h.is_gz = findex_is_gzip (in);
+  if (fwrite (&h, sizeof (h), 1, out) != 1 ||
+      (h.nb_entries > 0 && fwrite (entries, sizeof (findex_entry), h.nb_entries, out) != h.nb_entries)) err = 1;
+  if (!err && h.is_gz) {
+    err = findex_build_frames (in, &points, &nb_points);    //  frames of the writer, or inflate checkpoints
+    if (err == 3) err = findex_build_points (in, out, &points, &nb_points);
+  }
+  if (!err) {
+    h.nb_points  = nb_points;
+    h.points_pos = ftello (out);
+    if ((nb_points > 0 && fwrite (points, sizeof (findex_gz_point), nb_points, out) != nb_points) ||
+        fseeko (out, 0, SEEK_SET) != 0 || fwrite (&h, sizeof (h), 1, out) != 1) err = 1;
+  }
+  fclose (in);
+  if (fclose (out) != 0) err = 1;
+  if (err) remove (idxname);
+  free (entries);
+  free (points);
+  return err;
+}
+
+
+int findex_read (const char* idxname, findex** idx) {
+  findex_header h;
+  findex*       x;
+  FILE*         f;
+  int           err = 0;
+  *idx = NULL;
+  f = fopen (idxname, "rb");
+  if (f == NULL) return 1;
+  if (fread (&h, sizeof (h), 1, f) != 1 || memcmp (h.magic, FINDEX_MAGIC, 4) != 0 || h.version != FINDEX_VERSION) {
+    fclose (f);
+    return 3;
+  }
+  x = (findex*) calloc (1, sizeof (findex));
+  if (x == NULL) {
+    fclose (f);
+    return 2;
+  }
+  x->idxname    = strdup (idxname);
+  x->is_gz      = h.is_gz;
+  x->nb_entries = h.nb_entries;
+  x->nb_points  = h.nb_points;
+  x->data_size  = h.data_size;
+  x->data_mtime = h.data_mtime;
+  x->entries    = (findex_entry*)    malloc ((h.nb_entries + 1) * sizeof (findex_entry));
+  x->points     = (findex_gz_point*) malloc ((h.nb_points  + 1) * sizeof (findex_gz_point));
+  if (x->idxname == NULL || x->entries == NULL || x->points == NULL) err = 2;
+  if (!err && fread (x->entries, sizeof (findex_entry), h.nb_entries, f) != h.nb_entries) err = 3;
+  if (!err && (fseeko (f, h.points_pos, SEEK_SET) != 0 ||
+               fread  (x->points, sizeof (findex_gz_point), h.nb_points, f) != h.nb_points)) err = 3;
+  fclose (f);
+  if (err) {
+    findex_free (x);
+    return err;
+  }
+  *idx = x;
+  return 0;
+}
+
+
+void findex_free (findex* idx) {
+  if (idx == NULL) return;
+  free (idx->idxname);
+  free (idx->entries);
+  free (idx->points);
+  free (idx);
+}
+
+
+void findex_filename (const char* filename, char* idxname) {
+  sprintf (idxname, "%s.idx", filename);
+}
+
+
+static int findex_stat_check (const findex* idx, const struct stat* st) {
+  if ((unsigned long long) st->st_size != idx->data_size || (long long) st->st_mtime != idx->data_mtime) return 3;
+  return 0;
+}
+
+
+int findex_check (const findex* idx, const char* filename) {
+  struct stat st;
+  if (idx == NULL || stat (filename, &st) != 0) return 1;
+  return findex_stat_check (idx, &st);
+}
+
+
+static int findex_reader_entry_match (const findex_reader_t* r, const findex_entry* e) {
+  return findex_entry_overlaps (e, r->pred.from_ns, r->pred.to_ns) &&
+         (r->pred.all_labels || findex_bitmaps_meet (e->labels, r->labels,     FINDEX_LABEL_BITMAP_SIZE)) &&
+         (r->pred.all_types  || findex_bitmaps_meet (e->types,  r->pred.types, FINDEX_TYPE_BITMAP_SIZE));
+}
+
+
+//--------------------------------------------------//
+
+//  PREDICATE
+
+void findex_predicate_init (findex_predicate* pred) {
+  memset (pred, 0, sizeof (findex_predicate));
+  pred->to_ns      = ~0ULL;
+  pred->all_labels = 1;
+  pred->all_types  = 1;
+}
+
+
+void findex_predicate_window (findex_predicate* pred, unsigned long long from_ns, unsigned long long to_ns) {
+  pred->from_ns = from_ns;
+  pred->to_ns   = to_ns;
+}
+
+
+void findex_predicate_label (findex_predicate* pred, unsigned short label) {
+  pred->all_labels = 0;
+  pred->labels [label / 8] |= 1 << (label % 8);
+}
+
+
+void findex_predicate_type (findex_predicate* pred, unsigned char type_alias) {
+  pred->all_types = 0;
+  pred->types [type_alias / 8] |= 1 << (type_alias % 8);
+}
+
+
+int findex_predicate_match (const findex_predicate* pred, faster_data_p data) {
+  unsigned long long clock = faster_data_clock_ns (data);
+  group_ungroup      ug;
+  faster_data_p      leaf;
+  if (clock < pred->from_ns || clock >= pred->to_ns) return 0;
+  if (findex_leaf_match (pred, data)) return 1;
+  if (faster_data_type_alias (data) != GROUP_TYPE_ALIAS) return 0;
+  group_ungroup_init (&ug, data);
+  while ((leaf = group_ungroup_next (&ug, NULL)) != NULL) {
+    if (findex_leaf_match (pred, leaf)) return 1;
+  }
+  return 0;
+}
+
+
+//--------------------------------------------------//
+
+//  READERS
+
+findex_reader_p findex_reader_open (const char* filename, const findex* idx,
+                                    unsigned long long from_ns, unsigned long long to_ns) {
+  findex_predicate pred;
+  findex_predicate_init   (&pred);
+  findex_predicate_window (&pred, from_ns, to_ns);
+  return findex_reader_open_predicate (filename, idx, &pred);
+}
+
+
+findex_reader_p findex_reader_open_predicate (const char* filename, const findex* idx, const findex_predicate* pred) {
+  findex_reader_t* r;
+  struct stat      st;
+  int              label;
+  if (idx == NULL || pred == NULL) return NULL;
+  r = (findex_reader_t*) calloc (1, sizeof (findex_reader_t));
+  if (r == NULL) return NULL;
+  r->src.idx  = idx;
+  r->src.file = fopen (filename, "rb");
+  if (r->src.file != NULL && (fstat (fileno (r->src.file), &st) != 0 || findex_stat_check (idx, &st) != 0)) {
+    fclose (r->src.file);                                    //  index of another version of the file
+    r->src.file = NULL;
+  }
+  if (r->src.file != NULL && idx->is_gz) r->src.idxfile = fopen (idx->idxname, "rb");
+  if (r->src.file == NULL || (idx->is_gz && r->src.idxfile == NULL)) {
+    findex_reader_close (r);
+    return NULL;
+  }
+  r->pred = *pred;
+  for (label=0; label<65536; label++) {                      //  label set => entries bitmap
+    if (pred->labels [label / 8] & (1 << (label % 8))) r->labels [(label % 256) / 8] |= 1 << (label % 8);
+  }
+  return r;
+}
+
+
+faster_data_p findex_reader_next (findex_reader_p reader) {
+  findex_reader_t*    r   = (findex_reader_t*) reader;
+  const findex*       idx = r->src.idx;
+  const findex_entry* e;
+  unsigned char*      data;
+  size_t              avail;
+  unsigned short      load_size;
+  while (1) {
+    while (r->left == 0) {                                   //  next entry that may match
+      while (r->entry < idx->nb_entries && !findex_reader_entry_match (r, &idx->entries [r->entry])) {
+        r->entry += 1;
+      }
+      if (r->entry == idx->nb_entries) return NULL;
+      e = &idx->entries [r->entry];
+      if (r->src.pos + r->src.out_pos != e->offset || (idx->is_gz && !r->src.strm_on)) {
+        if (!findex_source_seek (&r->src, e->offset)) return NULL;
+      }
+      r->left   = e->nb_data;
+      r->entry += 1;
+    }
+    avail = r->src.out_len - r->src.out_pos;
+    data  = r->src.out + r->src.out_pos;
+    if (avail >= FINDEX_DATA_HEADER && avail >= (size_t) FINDEX_DATA_HEADER + faster_data_load_size (data)) {
+      r->src.out_pos += FINDEX_DATA_HEADER + faster_data_load_size (data);   //  whole data in the buffer
+    } else {                                                                 //  across buffers : copied
+      if (!findex_source_read (&r->src, r->data, FINDEX_DATA_HEADER)) return NULL;
+      load_size = faster_data_load_size (r->data);
+      if (!findex_source_read (&r->src, r->data + FINDEX_DATA_HEADER, load_size)) return NULL;
+      data = r->data;
+    }
+    r->left -= 1;
+    if (findex_predicate_match (&r->pred, data)) return data;
+  }
+}
+
+
+void findex_reader_close (findex_reader_p reader) {
+  findex_reader_t* r = (findex_reader_t*) reader;
+  if (r == NULL) return;
+  if (r->src.strm_on) inflateEnd (&r->src.strm);
+  if (r->src.file    != NULL) fclose (r->src.file);
+  if (r->src.idxfile != NULL) fclose (r->src.idxfile);
+  free (r);
+}
@@ -20,7 +20,7 @@
 
 //--------------------------------------------------//
 
-void data_display (faster_data_p data, int n, int tab, int full) {
+void data_display (faster_data_p data, long long n, int tab, int full) {
   relative_data_display (data, n, tab, full, 0, TUNIT_NS);
 }
 
@@ -124,25 +124,24 @@ void group_display (faster_data_p      data,
   int                    i;
   faster_data_p          group_data;
   int                    group_n      = 0;
-  void*                  group_buffer = faster_data_load_p (data);
-  faster_buffer_reader_p group_reader = faster_buffer_reader_open (group_buffer, lsize);
+  group_iter             group_it;
+  group_iter_init (&group_it, data);
   printf ("\n");
   for (i=0; i<tab; i++) printf ("   ");
   printf ("           -------------------------------------------\n");
-  while ((group_data = faster_buffer_reader_next (group_reader)) != NULL) {
+  while ((group_data = group_iter_next (&group_it)) != NULL) {
     group_n += 1;
     relative_data_display (group_data, group_n, tab+1, full, clock, TUNIT_NS);
   }
   for (i=0; i<tab; i++) printf ("   ");
   printf ("           -------------------------------------------\n");
-  faster_buffer_reader_close (group_reader);
 }
 
 
 //--------------------------------------------------//
 
 void relative_data_display (faster_data_p      data,
-                            int                n,
+                            long long          n,
                             int                tab,
                             int                full,
                             unsigned long long ref_ns,
@@ -168,7 +167,7 @@ void relative_data_display (faster_data_p      data,
     sprintf (clk_str, "%15.2Lf%s", (long double) rel_clock / tunit_coef [tunit], tunit_str [tunit]);
   }
   for (i=0; i<tab; i++) printf ("   ");
-  printf ("%10d  ", n);
+  printf ("%10lld  ", n);
   printf ("%15s %5d  %s", type_name (alias), label, clk_str);
   if (alias == GROUP_TYPE_ALIAS) {
      group_display (data, lsize, clock, tab, full);
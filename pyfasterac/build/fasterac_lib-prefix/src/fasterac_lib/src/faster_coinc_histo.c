@@ -0,0 +1,311 @@
+/*
+ *  'faster_coinc_histo.c'
+ *
+ *  Two detectors coincidence histogram (E1 x E2) of grouped data files.
+ *
+ *  Each file is decoded in columns (fcolumns), the hits are calibrated
+ *  (polynomial of the charge / measure) and binned in flat loops, then
+ *  every (X, Y) pair of a group increments the 2D histogram.
+ *  The files are processed in parallel, one histogram per file
+ *  ('file.fast' => 'file.coinc.npy', or 'file.coinc.txt' with -t).
+ *
+ */
+
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "fasterac/fcolumns.h"       //  columns of the charge data
+
+
+#define MAX_COEFS         4
+#define DEFAULT_NB_BINS   200
+#define DEFAULT_MIN       0.0
+#define DEFAULT_MAX       2000.0
+
+
+/*
+ *  Configuration
+ */
+
+typedef struct detector {
+  unsigned short label;
+  int            nb_coefs;
+  double         coef [MAX_COEFS];   //  E = coef[0] + coef[1] q + coef[2] q^2 + ...
+} detector;
+
+typedef struct coinc_config {
+  detector       x;
+  detector       y;
+  int            nb_bins;
+  double         min;
+  double         max;
+  int            reject;             //  rejects saturated and pile up hits
+  int            text;               //  ascii output
+  const char*    outdir;
+  char**         files;
+  int            nb_files;
+  int            next_file;
+  int            nb_errors;
+  pthread_mutex_t lock;
+} coinc_config;
+
+
+int parse_detector (const char* arg, detector* det) {      //  LABEL:c0,c1,...
+  const char* p = strchr (arg, ':');
+  char*       end;
+  det->label    = atoi (arg);
+  det->nb_coefs = 0;
+  if (p == NULL) {                                          //  no calibration : E = q
+    det->coef [0] = 0;
+    det->coef [1] = 1;
+    det->nb_coefs = 2;
+    return 1;
+  }
+  p++;
+  while (*p != '\0' && det->nb_coefs < MAX_COEFS) {
+    det->coef [det->nb_coefs++] = strtod (p, &end);
+    if (end == p) return 0;
+    p = *end == ',' ? end + 1 : end;
+  }
+  return det->nb_coefs > 0 && *p == '\0';
+}
+
+
+/*
+ *  Histogram of a file
+ */
+
+void calibrate_and_bin (const fcolumns* col, const detector* det, const coinc_config* cfg, int* bin) {
+  unsigned long long i;
+  double             e;
+  double             q;
+  double             scale = cfg->nb_bins / (cfg->max - cfg->min);
+  int                k;
+  for (i=0; i<col->nb_data; i++) {                          //  flat loop (vectorizable)
+    q = col->q [i];
+    e = det->coef [det->nb_coefs - 1];
+    for (k=det->nb_coefs-2; k>=0; k--) e = e * q + det->coef [k];
+    e = (e - cfg->min) * scale;
+    bin [i] = (e >= 0 && e < cfg->nb_bins) ? (int) e : -1;
+  }
+  for (i=0; i<col->nb_data; i++) {                          //  other labels out of the histogram
+    if (col->label [i] != det->label) bin [i] = -1;
+    if (cfg->reject && (col->flags [i] & (FCOLUMNS_SATURATED | FCOLUMNS_PILEUP))) bin [i] = -1;
+  }
+}
+
+
+unsigned long long fill_pairs (const fcolumns* col, const int* bx, const int* by, int nb_bins, unsigned int* histo) {
+  unsigned long long first = 0;                             //  first hit of the current group
+  unsigned long long last;
+  unsigned long long i, j;
+  unsigned long long nb_pairs = 0;
+  while (first < col->nb_data) {
+    last = first + 1;
+    if (col->flags [first] & FCOLUMNS_IN_GROUP) {
+      while (last < col->nb_data && (col->flags [last] & (FCOLUMNS_IN_GROUP | FCOLUMNS_GROUP_START)) == FCOLUMNS_IN_GROUP) last++;
+      for (i=first; i<last; i++) {
+        if (bx [i] < 0) continue;
+        for (j=first; j<last; j++) {
+          if (by [j] < 0 || j == i) continue;
+          histo [bx [i] * nb_bins + by [j]] += 1;
+          nb_pairs += 1;
+        }
+      }
+    }
+    first = last;
+  }
+  return nb_pairs;
+}
+
+
+int write_npy (const char* name, const unsigned int* histo, int nb_bins) {
+  char   header [128];
+  int    len;
+  int    err = 0;
+  FILE*  f = fopen (name, "wb");
+  if (f == NULL) return 1;
+  len = snprintf (header + 10, sizeof (header) - 10,
+                  "{'descr': '<u4', 'fortran_order': False, 'shape': (%d, %d), }", nb_bins, nb_bins);
+  while ((10 + len + 1) % 64 != 0) header [10 + len++] = ' ';
+  header [10 + len++] = '\n';
+  memcpy (header, "\x93NUMPY\x01\x00", 8);
+  header [8] = len & 0xFF;
+  header [9] = len >> 8;
+  if (fwrite (header, 10 + len, 1, f) != 1 ||
+      fwrite (histo, sizeof (unsigned int), (size_t) nb_bins * nb_bins, f) != (size_t) nb_bins * nb_bins) err = 1;
+  if (fclose (f) != 0) err = 1;
+  return err;
+}
+
+
+int write_text (const char* name, const unsigned int* histo, const coinc_config* cfg) {
+  double bin_size = (cfg->max - cfg->min) / cfg->nb_bins;
+  int    i, j;
+  FILE*  f = fopen (name, "w");
+  if (f == NULL) return 1;
+  for (i=0; i<cfg->nb_bins; i++) {
+    for (j=0; j<cfg->nb_bins; j++) {
+      if (histo [i * cfg->nb_bins + j] > 0) {
+        fprintf (f, "%f %f %u\n", cfg->min + (i + 0.5) * bin_size, cfg->min + (j + 0.5) * bin_size,
+                 histo [i * cfg->nb_bins + j]);
+      }
+    }
+  }
+  if (ferror (f)) {
+    fclose (f);
+    return 1;
+  }
+  return fclose (f) != 0;
+}
+
+
+int process_file (const char* filename, coinc_config* cfg) {
+  fcolumns           col;
+  int*               bx;
+  int*               by;
+  unsigned int*      histo;
+  unsigned long long nb_pairs;
+  char               outname [1024];
+  const char*        base;
+  size_t             len;
+  int                err;
+  err = fcolumns_from_fast (filename, &col);
+  if (err) {
+    printf ("error reading %s (%d)\n", filename, err);
+    return err;
+  }
+  bx    = (int*)          malloc ((col.nb_data + 1) * sizeof (int));
+  by    = (int*)          malloc ((col.nb_data + 1) * sizeof (int));
+  histo = (unsigned int*) calloc ((size_t) cfg->nb_bins * cfg->nb_bins, sizeof (unsigned int));
+  if (bx == NULL || by == NULL || histo == NULL) {
+    printf ("error allocating memory for %s\n", filename);
+    err = 2;
+  } else {
+    calibrate_and_bin (&col, &cfg->x, cfg, bx);
+    calibrate_and_bin (&col, &cfg->y, cfg, by);
+    nb_pairs = fill_pairs (&col, bx, by, cfg->nb_bins, histo);
+    base = cfg->outdir != NULL && strrchr (filename, '/') != NULL ? strrchr (filename, '/') + 1 : filename;
+    len  = strlen (base);
+    if (len > 5 && strcmp (base + len - 5, ".fast") == 0) len -= 5;
+    if (cfg->outdir != NULL) snprintf (outname, sizeof (outname), "%s/%.*s.coinc.%s", cfg->outdir, (int) len, base, cfg->text ? "txt" : "npy");
+    else                     snprintf (outname, sizeof (outname), "%.*s.coinc.%s", (int) len, base, cfg->text ? "txt" : "npy");
+    err = cfg->text ? write_text (outname, histo, cfg) : write_npy (outname, histo, cfg->nb_bins);
+    if (err) printf ("error writing %s\n", outname);
+    else     printf ("%s : %llu hits, %llu pairs => %s\n", filename, col.nb_data, nb_pairs, outname);
+  }
+  free (bx);
+  free (by);
+  free (histo);
+  fcolumns_free (&col);
+  return err;
+}
+
+
+void* worker (void* arg) {
+  coinc_config* cfg = (coinc_config*) arg;
+  int           f;
+  while (1) {
+    pthread_mutex_lock   (&cfg->lock);
+    f = cfg->next_file++;
+    pthread_mutex_unlock (&cfg->lock);
+    if (f >= cfg->nb_files) break;
+    if (process_file (cfg->files [f], cfg) != 0) {
+      pthread_mutex_lock   (&cfg->lock);
+      cfg->nb_errors += 1;
+      pthread_mutex_unlock (&cfg->lock);
+    }
+  }
+  return NULL;
+}
+
+
+
+/*
+ *  Main prog
+ */
+
+void display_usage (char* prog) {
+  printf ("\nusage : \n");
+  printf ("        %s  -x LABEL[:c0,c1,...]  -y LABEL[:c0,c1,...]  [-n NB_BINS]  [-r MIN:MAX]\n", prog);
+  printf ("        %*s  [-s]  [-t]  [-o OUTDIR]  [-j THREADS]  file1.fast  [file2.fast ...]\n", (int) strlen (prog), "");
+  printf ("\n");
+  printf ("        -x, -y LABEL:c0,c1,... : detector labels and calibration polynomials\n");
+  printf ("                                 E = c0 + c1 q + c2 q^2 + c3 q^3 [default: E = q],\n");
+  printf ("        -n NB_BINS             : bins per axis [default: %d],\n", DEFAULT_NB_BINS);
+  printf ("        -r MIN:MAX             : energy range of both axes [default: %g:%g],\n", DEFAULT_MIN, DEFAULT_MAX);
+  printf ("        -s                     : rejects saturated and pile up hits,\n");
+  printf ("        -t                     : ascii output 'E1 E2 count' (non empty bins) instead of numpy,\n");
+  printf ("        -o OUTDIR              : output directory [default: next to the input files],\n");
+  printf ("        -j THREADS             : files processed in parallel [default: nb of cores].\n");
+  printf ("\n");
+  printf ("        Every (X, Y) pair of a group fills the histogram 'file.coinc.npy'\n");
+  printf ("        (uint32, shape NB_BINS x NB_BINS, [E1 bin][E2 bin]).\n");
+  printf ("\n");
+  printf ("  example : \n");
+  printf ("        %s  -x 1:-52.86,0.001761  -y 2:-27.02,0.001827  compton_*.fast\n", prog);
+  printf ("\n");
+}
+
+
+int main (int argc, char** argv) {
+  coinc_config    cfg;
+  pthread_t*      threads;
+  int             nb_threads = sysconf (_SC_NPROCESSORS_ONLN);
+  int             has_x = 0;
+  int             has_y = 0;
+  struct timespec t0, t1;
+  double          elapsed;
+  int             nb_started = 0;
+  int             opt;
+  int             i;
+
+  memset (&cfg, 0, sizeof (cfg));
+  cfg.nb_bins = DEFAULT_NB_BINS;
+  cfg.min     = DEFAULT_MIN;
+  cfg.max     = DEFAULT_MAX;
+  while ((opt = getopt (argc, argv, "x:y:n:r:sto:j:h")) != -1) {   //  command args & usage
+    switch (opt) {
+      case 'x': has_x = parse_detector (optarg, &cfg.x);                 break;
+      case 'y': has_y = parse_detector (optarg, &cfg.y);                 break;
+      case 'n': cfg.nb_bins = atoi (optarg);                             break;
+      case 'r': if (sscanf (optarg, "%lf:%lf", &cfg.min, &cfg.max) != 2) cfg.max = cfg.min; break;
+      case 's': cfg.reject = 1;                                          break;
+      case 't': cfg.text   = 1;                                          break;
+      case 'o': cfg.outdir = optarg;                                     break;
+      case 'j': nb_threads = atoi (optarg);                              break;
+      default : display_usage (argv [0]); return EXIT_SUCCESS;
+    }
+  }
+  if (!has_x || !has_y || cfg.nb_bins <= 0 || cfg.max <= cfg.min || optind >= argc) {
+    display_usage (argv [0]);
+    return EXIT_SUCCESS;
+  }
+  cfg.files    = argv + optind;
+  cfg.nb_files = argc - optind;
+  if (nb_threads < 1)            nb_threads = 1;
+  if (nb_threads > cfg.nb_files) nb_threads = cfg.nb_files;
+
+  clock_gettime (CLOCK_MONOTONIC, &t0);
+  pthread_mutex_init (&cfg.lock, NULL);
+  threads = (pthread_t*) malloc (nb_threads * sizeof (pthread_t));
+  for (i=0; threads != NULL && i<nb_threads; i++) {
+    if (pthread_create (&threads [i], NULL, worker, &cfg) != 0) break;
+  }
+  nb_started = threads != NULL ? i : 0;
+  if (nb_started == 0) worker (&cfg);                        //  no thread at all : files done here
+  for (i=0; i<nb_started; i++) pthread_join (threads [i], NULL);
+  pthread_mutex_destroy (&cfg.lock);
+  free (threads);
+  clock_gettime (CLOCK_MONOTONIC, &t1);
+  elapsed = (t1.tv_sec - t0.tv_sec) + 1e-9 * (t1.tv_nsec - t0.tv_nsec);
+  printf ("%d file%s in %.3f s\n", cfg.nb_files, cfg.nb_files > 1 ? "s" : "", elapsed);
+  return cfg.nb_errors > 0 ? 1 : EXIT_SUCCESS;
+}
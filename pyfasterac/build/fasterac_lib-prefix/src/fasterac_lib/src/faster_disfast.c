@@ -116,9 +116,9 @@ struct arguments {
   struct lt_list*    types;
   struct lt_list*    labels;
   int                short_fmt;
-  int                first;
+  long long          first;
   unsigned long long first_clock_ns;
-  int                number;
+  long long          number;
   time_unit          tunit;
   long double        duration;
   int                info;
@@ -158,7 +158,7 @@ struct arguments get_args (int argc, char** argv) {
   args.filename  = "";
   args.types     = NULL;
   args.labels    = NULL;
-  args.number    = INT_MAX;
+  args.number    = LLONG_MAX;
   args.first     = 0;
   args.first_clock_ns = 0;
   args.tunit     = TUNIT_NS;
@@ -181,7 +181,7 @@ struct arguments get_args (int argc, char** argv) {
 				args.labels = lt_list_append (args.labels, atoi (optarg));
 				break;
 			case 'n':
-				args.number = atoi (optarg);
+				args.number = atoll (optarg);
 				break;
 			case 's':
 				args.short_fmt = 1;
@@ -193,7 +193,7 @@ struct arguments get_args (int argc, char** argv) {
         else                                 args.tunit = TUNIT_NS;
 				break;
 			case 'f':
-				args.first = atoi (optarg);
+				args.first = atoll (optarg);
 				break;
                         case 'c':
                                 args.first_clock_ns = atoll (optarg);
@@ -281,16 +281,16 @@ int main (int argc, char** argv) {
   unsigned long long     duration_ns             = 0;
   unsigned long long     first_sel_ns            = 0;
   unsigned long long     previous_ns             = 0;
-  int                    i_first                 = 0;
-  int                    i_last                  = 0;
-  int                    nb_all                  = 0;
-  int                    nb_selected             = 0;
+  long long              i_first                 = 0;
+  long long              i_last                  = 0;
+  long long              nb_all                  = 0;
+  long long              nb_selected             = 0;
   int                    no_type                 = 1;
   int                    no_label                = 1;
-  int                    type_cnt  [UCHAR_MAX+1] = {0};
-  int                    label_cnt [USHRT_MAX+1] = {0};
+  long long              type_cnt  [UCHAR_MAX+1] = {0};
+  long long              label_cnt [USHRT_MAX+1] = {0};
   unsigned short         label_typ [USHRT_MAX+1] = {0};
-  int                    i;
+  long long              i;
   int                    n = 0;
 
   //  command line parse //
@@ -308,6 +308,11 @@ int main (int argc, char** argv) {
     return 1;
   }
   far = farray_new (data_space, space_size);
+  if (far == NULL) {
+    printf ("memory error\n");
+    farray_data_memory_free (data_space, space_size);
+    return 1;
+  }
   //
 
   i_first = 0;
@@ -413,31 +418,31 @@ int main (int argc, char** argv) {
     printf ("\n");
     printf ("                                count          %%          data/s\n\n");
     if (no_type && no_label) {
-      printf ("                     all   %10d %10.3f %15.2lf\n", nb_all, 100.0*nb_all/nb_all, 1e9*nb_all/duration_ns);
+      printf ("                     all   %10lld %10.3f %15.2lf\n", nb_all, 100.0*nb_all/nb_all, 1e9*nb_all/duration_ns);
     } else {
-      printf ("                selected   %10d %10.3f %15.2lf\n", nb_selected, 100.0*nb_selected/nb_all, 1e9*nb_selected/duration_ns);
-      printf ("                     all   %10d %10.3f %15.2lf\n", nb_all, 100.0*nb_all/nb_all, 1e9*nb_all/duration_ns);
+      printf ("                selected   %10lld %10.3f %15.2lf\n", nb_selected, 100.0*nb_selected/nb_all, 1e9*nb_selected/duration_ns);
+      printf ("                     all   %10lld %10.3f %15.2lf\n", nb_all, 100.0*nb_all/nb_all, 1e9*nb_all/duration_ns);
     }
     printf("\n");
     printf ("COMPOSITION BY TYPES\n");
     printf ("\n");
     printf ("  type num       type name      count          %%          data/s\n\n");
     for (i=0; i<=UCHAR_MAX; i++) {
-      if (type_cnt [i] != 0) printf("%10d %15s %10d %10.3f %15.2f\n", i, type_name (i), type_cnt[i], 100.0*type_cnt[i]/nb_all, 1e9*type_cnt[i]/duration_ns);
+      if (type_cnt [i] != 0) printf("%10lld %15s %10lld %10.3f %15.2f\n", i, type_name (i), type_cnt[i], 100.0*type_cnt[i]/nb_all, 1e9*type_cnt[i]/duration_ns);
     }
     printf("\n");
     printf ("COMPOSITION BY LABELS\n");
     printf ("\n");
     printf ("     label            type      count          %%          data/s\n\n");
     for (i=0; i<=USHRT_MAX; i++) {
-      if (label_cnt [i] != 0) printf("%10d %15s %10d %10.3f %15.2f\n", i, type_name (label_typ[i]), label_cnt[i], 100.0*label_cnt[i]/nb_all, 1e9*label_cnt[i]/duration_ns);
+      if (label_cnt [i] != 0) printf("%10lld %15s %10lld %10.3f %15.2f\n", i, type_name (label_typ[i]), label_cnt[i], 100.0*label_cnt[i]/nb_all, 1e9*label_cnt[i]/duration_ns);
     }
     printf ("\n");
   }
 
   // ZZZZZZZZZZZZ
   if (args.z > 0)
-  printf ("t=%Ldns  previous_idx=%d  nearest_idx=%d  next_idx=%d\n",
+  printf ("t=%Ldns  previous_idx=%lld  nearest_idx=%lld  next_idx=%lld\n",
                                                            args.z,
                                                            farray_previous_idx (*far, args.z),
                                                            farray_nearest_idx  (*far, args.z),
@@ -447,7 +452,7 @@ int main (int argc, char** argv) {
 
   // dealloc data space
   farray_free (far);
-  free (data_space);
+  farray_data_memory_free (data_space, space_size);
   return EXIT_SUCCESS;
 }
 
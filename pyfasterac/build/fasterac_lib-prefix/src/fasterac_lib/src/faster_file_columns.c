@@ -0,0 +1,57 @@
+/*
+ *  'faster_file_columns.c'
+ *
+ *  Convert the charge / energy data of a file to a column file
+ *  (label, clock_ns, q, flags arrays, see 'fasterac/fcolumns.h').
+ *
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "fasterac/fcolumns.h"       //  columns
+
+
+void display_usage (char* prog) {
+  printf ("\nusage : \n");
+  printf ("        %s  input_file.fast   output_file.fcol\n", prog);
+  printf ("\n");
+  printf ("        qdc_x1, qdc_t_x1 and crrc4_spectro data (grouped or not) are written as columns :\n");
+  printf ("        label (uint16), clock_ns (uint64), q (int32, q1 or measure), flags (uint8 :\n");
+  printf ("        1 saturated, 2 pileup, 4 first data of a group, 8 data of a group).\n");
+  printf ("\n");
+}
+
+
+int main (int argc, char** argv) {
+  fcolumns        col;
+  struct timespec t0, t1;
+  double          elapsed;
+  int             err;
+
+  if (argc < 3) {                                            //  command args & usage
+    display_usage (argv [0]);
+    return EXIT_SUCCESS;
+  }
+
+  clock_gettime (CLOCK_MONOTONIC, &t0);
+  err = fcolumns_from_fast (argv [1], &col);
+  if (err) {
+    printf ("error reading %s (%d)\n", argv [1], err);
+    return err;
+  }
+  err = fcolumns_write (&col, argv [2]);
+  if (err) {
+    printf ("error writing %s\n", argv [2]);
+    fcolumns_free (&col);
+    return err;
+  }
+  clock_gettime (CLOCK_MONOTONIC, &t1);
+  elapsed = (t1.tv_sec - t0.tv_sec) + 1e-9 * (t1.tv_nsec - t0.tv_nsec);
+  printf ("%llu data written to %s in %.3f s\n", col.nb_data, argv [2], elapsed);
+  fcolumns_free (&col);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+/*
+ *  'faster_file_index.c'
+ *
+ *  Build the index of a data file ('file.fast.idx'), or extract
+ *  the data of a time window, of labels and of types from an indexed file.
+ *
+ */
+
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <time.h>
+
+#include "fasterac/fasterac.h"       //  generic data
+#include "fasterac/findex.h"         //  time index
+
+
+#define DEFAULT_NB_DATA  4096
+
+
+void display_usage (char* prog) {
+  printf ("\nusage : \n");
+  printf ("        %s  [-n NB_DATA]  [-t STEP_US]  file.fast\n", prog);
+  printf ("        %s  [-w FROM_US:TO_US]  [-l LABELS]  [-a TYPES]  file.fast  output.fast\n", prog);
+  printf ("\n");
+  printf ("        -n NB_DATA   : data per index entry [default: %d],\n", DEFAULT_NB_DATA);
+  printf ("        -t STEP_US   : max time span of an index entry in us [default: none],\n");
+  printf ("        -w FROM:TO   : writes the data such as FROM <= clock < TO (us) to output.fast,\n");
+  printf ("        -l LABELS    : writes the data of these labels (e.g. 1,2,1001-1002),\n");
+  printf ("        -a TYPES     : writes the data of these type aliases (e.g. 81 for crrc4_spectro),\n");
+  printf ("                       groups are written when one of their data is selected,\n");
+  printf ("                       only the index entries that may match are read (file.fast.idx).\n");
+  printf ("\n");
+}
+
+
+int parse_list (const char* list, findex_predicate* pred, int is_label) {   //  a,b-c,... (0 on error)
+  const char* p = list;
+  char*       end;
+  long        from;
+  long        to;
+  long        v;
+  while (*p != '\0') {
+    from = strtol (p, &end, 0);
+    if (end == p) return 0;
+    to = from;
+    p  = end;
+    if (*p == '-') {
+      to = strtol (p + 1, &end, 0);
+      if (end == p + 1) return 0;
+      p = end;
+    }
+    if (from < 0 || to < from || to > (is_label ? 65535 : 255)) return 0;
+    for (v=from; v<=to; v++) {
+      if (is_label) findex_predicate_label (pred, (unsigned short) v);
+      else          findex_predicate_type  (pred, (unsigned char)  v);
+    }
+    if (*p == ',') p++;
+    else if (*p != '\0') return 0;
+  }
+  return 1;
+}
+
+
+int main (int argc, char** argv) {
+  char               idxname [1024];
+  findex*            idx;
+  findex_reader_p    reader;
+  findex_predicate   pred;
+  faster_data_p      data;
+  faster_file_writer_p out;
+  unsigned int       nb_data_step = DEFAULT_NB_DATA;
+  unsigned long long step_ns      = 0;
+  double             from_us      = -1;
+  double             to_us        = -1;
+  int                extract      = 0;
+  unsigned long long nb_data      = 0;
+  struct timespec    t0, t1;
+  double             elapsed;
+  int                err;
+  int                opt;
+
+  findex_predicate_init (&pred);
+  while ((opt = getopt (argc, argv, "n:t:w:l:a:h")) != -1) { //  command args & usage
+    switch (opt) {
+      case 'n': nb_data_step = atoi (optarg);                     break;
+      case 't': step_ns      = (unsigned long long) (atof (optarg) * 1000); break;
+      case 'w': if (sscanf (optarg, "%lf:%lf", &from_us, &to_us) != 2 || from_us < 0 || to_us < from_us) {
+                  display_usage (argv [0]);
+                  return EXIT_SUCCESS;
+                }
+                findex_predicate_window (&pred, (unsigned long long) (from_us * 1000),
+                                                (unsigned long long) (to_us   * 1000));
+                extract = 1;
+                break;
+      case 'l':
+      case 'a': if (!parse_list (optarg, &pred, opt == 'l')) {
+                  display_usage (argv [0]);
+                  return EXIT_SUCCESS;
+                }
+                extract = 1;
+                break;
+      default : display_usage (argv [0]); return EXIT_SUCCESS;
+    }
+  }
+  if (argc - optind < 1 || (extract && argc - optind < 2)) {
+    display_usage (argv [0]);
+    return EXIT_SUCCESS;
+  }
+  findex_filename (argv [optind], idxname);
+  clock_gettime (CLOCK_MONOTONIC, &t0);
+
+  if (!extract) {                                             //  build the index
+    err = findex_build (argv [optind], idxname, nb_data_step, step_ns);
+    if (err) {
+      printf ("error indexing %s (%d)\n", argv [optind], err);
+      return err;
+    }
+    if (findex_read (idxname, &idx) == 0) {
+      clock_gettime (CLOCK_MONOTONIC, &t1);
+      elapsed = (t1.tv_sec - t0.tv_sec) + 1e-9 * (t1.tv_nsec - t0.tv_nsec);
+      printf ("%s : %llu entries, %llu inflate points (%.3f s)\n",
+              idxname, idx->nb_entries, idx->nb_points, elapsed);
+      findex_free (idx);
+    }
+    return EXIT_SUCCESS;
+  }
+
+  err = findex_read (idxname, &idx);                          //  extract the selected data
+  if (!err) {
+    err = findex_check (idx, argv [optind]);
+    if (err == 3) printf ("index %s is out of date, rebuild it : %s %s\n", idxname, argv [0], argv [optind]);
+    if (err) findex_free (idx);
+  }
+  if (err) {
+    printf ("error reading index %s (%d)\n", idxname, err);
+    return err;
+  }
+  reader = findex_reader_open_predicate (argv [optind], idx, &pred);
+  if (reader == NULL) {
+    printf ("error opening %s\n", argv [optind]);
+    findex_free (idx);
+    return 1;
+  }
+  out = faster_file_writer_open (argv [optind + 1]);         //  compressed if named '.gz'
+  if (out == NULL) {
+    printf ("error opening %s\n", argv [optind + 1]);
+    findex_reader_close (reader);
+    findex_free (idx);
+    return 1;
+  }
+  while ((data = findex_reader_next (reader)) != NULL) {
+    faster_file_writer_next (out, data);
+    nb_data += 1;
+  }
+  err = faster_file_writer_close (out);
+  findex_reader_close (reader);
+  findex_free (idx);
+  if (err) {
+    printf ("error writing %s\n", argv [optind + 1]);
+    return err;
+  }
+  clock_gettime (CLOCK_MONOTONIC, &t1);
+  elapsed = (t1.tv_sec - t0.tv_sec) + 1e-9 * (t1.tv_nsec - t0.tv_nsec);
+  printf ("%llu data extracted in %.3f s\n", nb_data, elapsed);
+  return EXIT_SUCCESS;
+}
@@ -22,7 +22,7 @@ int main (int argc, char** argv) {
   unsigned long long c1     = 0;                         //  clock
   unsigned long long c2     = 0;                         //  clock to compare
   int                sorted = 1;                         //  the file is sorted
-  int                i;                                  //
+  long long          i;                                  //
 
   if (argc < 2) {                                        //  command args & usage
     printf ("\nusage : \n");
@@ -37,6 +37,11 @@ int main (int argc, char** argv) {
     return 1;
   }
   far = farray_new (data_space, space_size);             //  create far with data space
+  if (far == NULL) {
+    printf ("memory error\n");
+    farray_data_memory_free (data_space, space_size);
+    return 2;
+  }
 
   c1 = far->first_ns;                                    //  get first clock
   for (i=1; i < far->nb_data; i++) {                     //  loop on data
@@ -52,7 +57,7 @@ int main (int argc, char** argv) {
   }
 
   farray_free (far);                                     //  free allocated memory
-  free (data_space);
+  farray_data_memory_free (data_space, space_size);
   if (sorted) printf ("Data file OK\n");
   return EXIT_SUCCESS;
 
@@ -3,6 +3,14 @@
  *
  *  Convert an unsorted data file to a sorted one.
  *
+ *  The input file is read sequentially and cut in runs fitting the memory
+ *  limit. Each run is sorted in memory (farray_sort_by_clock) and, when the
+ *  whole file doesn't fit in a single run, spilled to a temporary file. The runs are then merged
+ *  (k-way merge with a heap) to the output file.
+ *
+ *  The output is compressed (gzip frames deflated in parallel) when its
+ *  name ends with '.gz' or with the option -z.
+ *
  */
 
 
@@ -10,65 +18,340 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <time.h>
 
 #include "fasterac/fasterac.h"       //  generic data, file reader and writer
-#include "fasterac/farray.h"           //  faster file in memory
+#include "fasterac/farray.h"         //  sort by clock
+
+
+#define DEFAULT_MEMORY_MB  1024
+#define DATA_HEADER_SIZE   12
+#define DATA_MAX_SIZE      (DATA_HEADER_SIZE + 65535)
+#define SORT_BYTES_PER_DATA 40                 //  data pointer + radix sort keys
+#define MERGE_MIN_BUFSIZE  65536                 //  min read buffer of a run during the merge
 
 
 /*
- *  Comparison function for qsort (man qsort)
+ *  Comparison function for qsort (man qsort), used when the radix sort
+ *  can't get its memory.
  *  Function prototype : int(*compar)(const void *, const void *)
+ *
+ *  Integer clocks ; equal clocks keep the order of the run buffer
+ *  (data are appended to the buffer in reading order).
  */
 
 int compare_data_clocks (const void* data1, const void* data2) {
   faster_data_p *d1 = (faster_data_p*) data1;
   faster_data_p *d2 = (faster_data_p*) data2;
-  long double dt;
-  dt = faster_data_clock_sec (*d1) - faster_data_clock_sec (*d2);
-  if (dt > 0) return  1;
-  if (dt < 0) return -1;
+  unsigned long long c1 = faster_data_clock_ns (*d1);
+  unsigned long long c2 = faster_data_clock_ns (*d2);
+  if (c1 > c2) return  1;
+  if (c1 < c2) return -1;
+  if (*d1 > *d2) return  1;
+  if (*d1 < *d2) return -1;
   return 0;
 }
 
 
+/*
+ *  Run in memory
+ */
+
+typedef struct run_buffer {
+  char*              space;          //  data space
+  size_t             space_size;
+  size_t             used;
+  faster_data_p*     data_array;     //  data of the run
+  size_t             max_data;
+  size_t             nb_data;
+} run_buffer;
+
+
+int run_buffer_append (run_buffer* run, faster_data_p data) {
+  size_t width = DATA_HEADER_SIZE + faster_data_load_size (data);
+  if (run->used + width > run->space_size || run->nb_data == run->max_data) return 0;
+  memcpy (run->space + run->used, data, width);
+  run->data_array [run->nb_data] = run->space + run->used;
+  run->used    += width;
+  run->nb_data += 1;
+  return 1;
+}
+
+
+void run_buffer_sort (run_buffer* run, int nb_threads) {
+  farray far;
+  far.data_array = run->data_array;
+  far.nb_data    = run->nb_data;
+  if (farray_sort_by_clock (&far, nb_threads) != 0) {
+    qsort (run->data_array, run->nb_data, sizeof (faster_data_p), compare_data_clocks);
+  }
+}
+
+
+int run_buffer_write (run_buffer* run, FILE* out) {          //  0 on success, 1 on file error
+  size_t i;
+  int    err = 0;
+  for (i=0; i<run->nb_data && !err; i++) {
+    if (fwrite (run->data_array [i], DATA_HEADER_SIZE + faster_data_load_size (run->data_array [i]), 1, out) != 1) err = 1;
+  }
+  if (fflush (out) != 0 || ferror (out)) err = 1;
+  run->used    = 0;
+  run->nb_data = 0;
+  return err;
+}
+
+
+void run_buffer_output (run_buffer* run, faster_file_writer_p out) {
+  size_t i;
+  for (i=0; i<run->nb_data; i++) faster_file_writer_next (out, run->data_array [i]);
+  run->used    = 0;
+  run->nb_data = 0;
+}
+
+
+/*
+ *  Run spilled to a temporary file
+ */
+
+typedef struct run_file {
+  FILE*              file;
+  char*              iobuf;
+  unsigned char      current [DATA_MAX_SIZE];
+  unsigned long long clock_ns;
+} run_file;
+
+
+FILE* run_file_create (const char* tmpdir) {
+  char  name [1024];
+  int   fd;
+  FILE* f;
+  snprintf (name, sizeof (name), "%s/faster_file_sort_XXXXXX", tmpdir);
+  fd = mkstemp (name);
+  if (fd < 0) return NULL;
+  unlink (name);                                           //  removed at close (or crash)
+  f = fdopen (fd, "w+");
+  if (f == NULL) close (fd);
+  return f;
+}
+
+
+int run_file_next (run_file* run) {      //  1 on success, 0 at end of run, -1 on read error or truncated data
+  unsigned short load_size;
+  size_t         n;
+  n = fread (run->current, 1, DATA_HEADER_SIZE, run->file);
+  if (n == 0 && feof (run->file) && !ferror (run->file)) return 0;
+  if (n != DATA_HEADER_SIZE) return -1;
+  load_size = faster_data_load_size (run->current);
+  if (load_size > 0 && fread (run->current + DATA_HEADER_SIZE, load_size, 1, run->file) != 1) return -1;
+  run->clock_ns = faster_data_clock_ns (run->current);
+  return 1;
+}
+
+
+/*
+ *  Min heap of run indexes (clock, then run number => stable merge)
+ */
+
+int run_before (run_file* runs, int r1, int r2) {
+  if (runs [r1].clock_ns != runs [r2].clock_ns) return runs [r1].clock_ns < runs [r2].clock_ns;
+  return r1 < r2;
+}
+
+void heap_down (int* heap, int n, run_file* runs, int i) {
+  int smallest;
+  int tmp;
+  while (1) {
+    smallest = i;
+    if (2*i+1 < n && run_before (runs, heap [2*i+1], heap [smallest])) smallest = 2*i+1;
+    if (2*i+2 < n && run_before (runs, heap [2*i+2], heap [smallest])) smallest = 2*i+2;
+    if (smallest == i) return;
+    tmp            = heap [i];
+    heap [i]        = heap [smallest];
+    heap [smallest] = tmp;
+    i = smallest;
+  }
+}
+
+
+int merge_runs (FILE** tmp_files, int nb_runs, size_t memory, faster_file_writer_p out) {
+  //  0 on success, 1 on temporary file error and 2 on memory error
+  run_file* runs = (run_file*) calloc (nb_runs, sizeof (run_file));
+  int*      heap = (int*)      malloc (sizeof (int) * nb_runs);
+  size_t    bufsize = memory / (nb_runs + 1);
+  int       n   = 0;
+  int       err = 0;
+  int       ret;
+  int       r;
+  if (bufsize < MERGE_MIN_BUFSIZE) bufsize = MERGE_MIN_BUFSIZE;
+  if (runs == NULL || heap == NULL) err = 2;
+  for (r=0; r<nb_runs && !err; r++) {
+    rewind (tmp_files [r]);
+    runs [r].file  = tmp_files [r];
+    runs [r].iobuf = (char*) malloc (bufsize);
+    if (runs [r].iobuf == NULL) {
+      err = 2;
+      break;
+    }
+    setvbuf (runs [r].file, runs [r].iobuf, _IOFBF, bufsize);
+    ret = run_file_next (&runs [r]);
+    if (ret < 0) err = 1;
+    if (ret > 0) heap [n++] = r;
+  }
+  for (r=n/2-1; r>=0 && !err; r--) heap_down (heap, n, runs, r);
+  while (n > 0 && !err) {
+    r = heap [0];
+    faster_file_writer_next (out, runs [r].current);
+    ret = run_file_next (&runs [r]);
+    if (ret < 0) err = 1;
+    if (ret == 0) heap [0] = heap [--n];
+    heap_down (heap, n, runs, 0);
+  }
+  for (r=0; r<nb_runs; r++) {
+    fclose (tmp_files [r]);
+    if (runs != NULL) free (runs [r].iobuf);
+  }
+  free (runs);
+  free (heap);
+  return err;
+}
+
+
 
 /*
  *  Main prog
  */
 
+void display_usage (char* prog) {
+  printf ("\nusage : \n");
+  printf ("        %s  [-m MEMORY_MB]  [-T TMPDIR]  [-j THREADS]  [-z LEVEL]  input_unsorted.fast   output_sorted.fast\n", prog);
+  printf ("\n");
+  printf ("        -m MEMORY_MB : memory used for sorting [default: %d MB],\n", DEFAULT_MEMORY_MB);
+  printf ("                       larger files are sorted by runs merged from temporary files,\n");
+  printf ("        -T TMPDIR    : directory of the temporary files [default: $TMPDIR or /tmp],\n");
+  printf ("        -j THREADS   : threads used to sort a run and to compress [default: nb of cores],\n");
+  printf ("        -z LEVEL     : gzip output, compression level 1-9 [default: raw output,\n");
+  printf ("                       gzip level %d if the output name ends with .gz].\n", FASTER_WRITER_DEFAULT_LEVEL);
+  printf ("\n");
+}
+
+
 int main (int argc, char** argv) {
-  char*                data_space;                           //  file in memory
-  size_t               space_size;
-  int                  error;
-  farray               *far;                                 //  faster data array
-  faster_file_writer_p writer;                               //  file writer
-  FILE*                f;                                    //  output file
-  int                  i;
-
-  if (argc < 3) {                                            //  command args & usage
-    printf ("\nusage : \n");
-    printf ("        %s  input_unsorted.fast   output_sorted.fast\n", argv[0]);
-    printf ("\n");
+  faster_file_reader_p reader;                               //  file reader
+  faster_data_p        data;
+  faster_file_writer_p out;                                  //  output file
+  FILE**               tmp_files = NULL;                     //  sorted runs
+  int                  nb_runs   = 0;
+  run_buffer           run;
+  size_t               memory    = (size_t) DEFAULT_MEMORY_MB << 20;
+  const char*          tmpdir    = getenv ("TMPDIR");
+  unsigned long long   nb_data   = 0;
+  struct timespec      t0, t1;
+  double               elapsed;
+  int                  nb_threads = sysconf (_SC_NPROCESSORS_ONLN);
+  int                  level      = 0;                     //  0 => from the output name
+  int                  err;
+  int                  opt;
+
+  if (tmpdir == NULL) tmpdir = "/tmp";
+  while ((opt = getopt (argc, argv, "m:T:j:z:h")) != -1) {   //  command args & usage
+    switch (opt) {
+      case 'm': memory     = (size_t) atol (optarg) << 20; break;
+      case 'T': tmpdir     = optarg;                       break;
+      case 'j': nb_threads = atoi (optarg);                break;
+      case 'z': level      = atoi (optarg);                break;
+      default : display_usage (argv [0]); return EXIT_SUCCESS;
+    }
+  }
+  if (argc - optind < 2 || memory < 2 * DATA_MAX_SIZE) {
+    display_usage (argv [0]);
     return EXIT_SUCCESS;
   }
 
-  error = farray_data_file_to_memory (argv [1], &data_space, &space_size);
-  if (error) {                                               // file to memory
-    printf ("error opening %s\n", argv [1]);
+  clock_gettime (CLOCK_MONOTONIC, &t0);
+  reader = faster_file_reader_open (argv [optind]);
+  if (reader == NULL) {
+    printf ("error opening %s\n", argv [optind]);
+    return 1;
+  }
+  run.max_data   = memory / 2 / SORT_BYTES_PER_DATA;         //  1/2 data pointers & sort keys, 1/2 data space
+  run.space_size = memory / 2;
+  run.space      = (char*)          malloc (run.space_size);
+  run.data_array = (faster_data_p*) malloc (run.max_data * sizeof (faster_data_p));
+  run.used       = 0;
+  run.nb_data    = 0;
+  if (run.space == NULL || run.data_array == NULL) {
+    printf ("error allocating %ld MB\n", (long) (memory >> 20));
+    return 2;
+  }
+
+  while ((data = faster_file_reader_next (reader)) != NULL) {  //  loop on data
+    if (!run_buffer_append (&run, data)) {                     //  run full => sort & spill
+      run_buffer_sort (&run, nb_threads);
+      tmp_files = (FILE**) realloc (tmp_files, sizeof (FILE*) * (nb_runs + 1));
+      tmp_files [nb_runs] = run_file_create (tmpdir);
+      if (tmp_files [nb_runs] == NULL) {
+        printf ("error creating temporary file in %s\n", tmpdir);
+        return 1;
+      }
+      if (run_buffer_write (&run, tmp_files [nb_runs]) != 0) {
+        printf ("error writing temporary file in %s\n", tmpdir);
+        return 1;
+      }
+      nb_runs += 1;
+      run_buffer_append (&run, data);
+    }
+    nb_data += 1;
+  }
+  faster_file_reader_close (reader);
+
+  if (level > 0) out = faster_file_writer_open_compressed (argv [optind + 1], FASTER_WRITER_GZIP, level, nb_threads);
+  else           out = faster_file_writer_open (argv [optind + 1]);
+  if (out == NULL) {
+    printf ("error opening %s\n", argv [optind + 1]);
     return 1;
   }
-  far = farray_new (data_space, space_size);                 //  create far with data_space
-  writer = faster_file_writer_open (argv [2]);               //  create a writer
-  qsort (far->data_array,
-         far->nb_data,
-         sizeof (faster_data_p*),
-         compare_data_clocks);                               //  sort the array (man qsort)
-  for (i=0; i < far->nb_data; i++) {                         //  loop on data
-    faster_file_writer_next (writer, far->data_array [i]);   //  put the array to output file
+  run_buffer_sort (&run, nb_threads);
+  if (nb_runs == 0) {                                        //  the whole file in memory
+    run_buffer_output (&run, out);
+  } else {                                                   //  last run spilled, then merge
+    tmp_files = (FILE**) realloc (tmp_files, sizeof (FILE*) * (nb_runs + 1));
+    tmp_files [nb_runs] = run_file_create (tmpdir);
+    if (tmp_files [nb_runs] == NULL) {
+      printf ("error creating temporary file in %s\n", tmpdir);
+      return 1;
+    }
+    if (run_buffer_write (&run, tmp_files [nb_runs]) != 0) {
+      printf ("error writing temporary file in %s\n", tmpdir);
+      faster_file_writer_close (out);
+      return 1;
+    }
+    nb_runs += 1;
+    free (run.space);                                        //  memory given to the merge
+    run.space = NULL;
+    err = merge_runs (tmp_files, nb_runs, memory, out);
+    if (err) {
+      printf ("error merging the runs (%s)\n", err == 2 ? "memory" : "temporary files");
+      faster_file_writer_close (out);
+      return err;
+    }
+  }
+  err = faster_file_writer_close (out);
+  free   (run.space);
+  free   (run.data_array);
+  free   (tmp_files);
+
+  if (err) {
+    printf ("error writing %s\n", argv [optind + 1]);
+    return err;
   }
-  free                     (data_space);                     //  free allocated memory
-  farray_free              (far);
-  faster_file_writer_close (writer);                         //  close the writer
+
+  clock_gettime (CLOCK_MONOTONIC, &t1);
+  elapsed = (t1.tv_sec - t0.tv_sec) + 1e-9 * (t1.tv_nsec - t0.tv_nsec);
+  printf ("%llu data sorted in %.3f s (%d run%s, %.0f data/s)\n",
+          nb_data, elapsed, nb_runs > 0 ? nb_runs : 1, nb_runs > 1 ? "s" : "",
+          elapsed > 0 ? nb_data / elapsed : 0.);
   return EXIT_SUCCESS;
 }
 
@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #include "fasterac/fasterac.h"       //  generic data, file reader and writer
 #include "fasterac/group.h"          //  group data
@@ -17,42 +18,30 @@
 
 
 /*
- *  Comparison function for qsort (man qsort)
- *  Function prototype : int(*compar)(const void *, const void *)
+ *  Number of data once ungrouped.
  */
 
-int compare_data_clocks (const void* data1, const void* data2) {
-  faster_data_p *d1 = (faster_data_p*) data1;
-  faster_data_p *d2 = (faster_data_p*) data2;
-  long double dt;
-  dt = faster_data_clock_sec (*d1) - faster_data_clock_sec (*d2);
-  if (dt > 0) return  1;
-  if (dt < 0) return -1;
-  return 0;
+long long ungrouped_count (faster_data_p data) {
+  group_ungroup ug;
+  long long     n = 0;
+  group_ungroup_init (&ug, data);
+  while (group_ungroup_next (&ug, NULL) != NULL) n++;
+  return n;
 }
 
 
 /*
  *  Put a single data to dataseq[pos] and increment pos.
- *  When data is a group, ungroup_to_dataseq each grouped data.
+ *  When data is a group, put each grouped data (nested groups flattened).
  */
 
-void ungroup_to_dataseq (faster_data_p data, faster_data_p* dataseq, int* pos) {
-  unsigned char          alias = faster_data_type_alias (data);
-  unsigned short         lsize = faster_data_load_size  (data);
-  faster_buffer_reader_p group_reader;
-  void*                  group_buffer;
-  faster_data_p          group_data;
-  if (alias != GROUP_TYPE_ALIAS) {
-    dataseq [*pos] = data;
+void ungroup_to_dataseq (faster_data_p data, faster_data_p* dataseq, long long* pos) {
+  group_ungroup ug;
+  faster_data_p leaf;
+  group_ungroup_init (&ug, data);
+  while ((leaf = group_ungroup_next (&ug, NULL)) != NULL) {
+    dataseq [*pos] = leaf;
     *pos           = *pos + 1;
-  } else {
-    group_buffer = faster_data_load_p (data);
-    group_reader = faster_buffer_reader_open (group_buffer, lsize);
-    while ((group_data = faster_buffer_reader_next (group_reader)) != NULL) {
-      ungroup_to_dataseq (group_data, dataseq, pos);
-    }
-    faster_buffer_reader_close (group_reader);
   }
 }
 
@@ -70,8 +59,10 @@ int main (int argc, char** argv) {
   FILE*                f;                                                           //  output file
   faster_data_p        data;                                                        //  a data
   faster_data_p*       ugrp_array;                                                  //  ungrouped and sorted resulting data array
-  int                  n = 0;                                                       //  nb of data to write
-  int                  i;
+  farray               ugrp;                                                        //  ungrouped array to sort
+  long long            nb_ungrouped = 0;                                            //  size of the ungrouped array
+  long long            n = 0;                                                       //  nb of data to write
+  long long            i;
 
   if (argc < 3) {                                                                   //  command args & usage
     printf ("\nusage : \n");
@@ -86,22 +77,46 @@ int main (int argc, char** argv) {
     return 1;
   }
   far = farray_new (data_space, space_size);                                        //  create far with data_space
-  out_writer = faster_file_writer_open (argv [2]);                                  //  create the output writer
-  ugrp_array = (faster_data_p*) malloc (sizeof (faster_data_p) * space_size/12);    //  maximize the allocation for the ungrouped array
+  if (far == NULL) {
+    printf ("error loading %s (memory)\n", argv [1]);
+    farray_data_memory_free (data_space, space_size);
+    return 2;
+  }
+  for (i=0; i < far->nb_data; i++) {                                                //  count the ungrouped data
+    nb_ungrouped += ungrouped_count (far->data_array [i]);
+  }
+  ugrp_array = (faster_data_p*) malloc (sizeof (faster_data_p) * (nb_ungrouped > 0 ? nb_ungrouped : 1));
+  if (ugrp_array == NULL) {
+    printf ("error ungrouping %s (memory)\n", argv [1]);
+    return 2;
+  }
   for (i=0; i < far->nb_data; i++) {                                                //  loop on data
     ungroup_to_dataseq (far->data_array [i], ugrp_array, &n);                       //  append data to ugrp_array and increment n
   }                                                                                 //  (ungroup if needed, recursive)
-  ugrp_array = (faster_data_p*) realloc (ugrp_array, sizeof (faster_data_p) * n);   //  adjust the sequence array size
-  qsort (ugrp_array, n, sizeof (faster_data_p*), compare_data_clocks);              //  sort the array (man qsort)
+  farray_free (far);                                                                //  ugrp_array points to the data space
+  out_writer = faster_file_writer_open (argv [2]);                                  //  create the output writer
+  if (out_writer == NULL) {
+    printf ("error opening %s\n", argv [2]);
+    return 1;
+  }
+  ugrp.data_array = ugrp_array;
+  ugrp.nb_data    = n;
+  if (farray_sort_by_clock (&ugrp, sysconf (_SC_NPROCESSORS_ONLN)) != 0) {          //  sort the array (stable radix sort)
+    printf ("error sorting %s (memory)\n", argv [1]);
+    return 2;
+  }
   for (i=0; i<n; i++) {                                                             //  loop on ugrp_array
     if (faster_data_type_alias (ugrp_array[i]) != GROUP_COUNTER_TYPE_ALIAS) {
       faster_file_writer_next (out_writer, ugrp_array [i]);                       //  output data to file
     }
   }                                                                                 //
-  faster_file_writer_close (out_writer);                                            //  close the writer
-  farray_free              (far);
-  free                     (data_space);                                            //  free allocated memory
+  error = faster_file_writer_close (out_writer);                                    //  close the writer
+  farray_data_memory_free  (data_space, space_size);                                //  free allocated memory
   free                     (ugrp_array);
+  if (error) {
+    printf ("error writing %s\n", argv [2]);
+    return error;
+  }
   return EXIT_SUCCESS;
 
 }
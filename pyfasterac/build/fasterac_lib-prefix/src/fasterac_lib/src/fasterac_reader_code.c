@@ -70,13 +70,11 @@ void type_selection (faster_data_p data, int* selection) {
       else if (alias == GROUP_COUNTER_TYPE_ALIAS)      selection [21] = 1;
       else if (alias == GROUP_TYPE_ALIAS){             selection [20] = 1;
          faster_data_p          group_data;
-         unsigned short         lsize        = faster_data_load_size     (data);
-         void*                  group_buffer = faster_data_load_p        (data);
-         faster_buffer_reader_p group_reader = faster_buffer_reader_open (group_buffer, lsize);
-         while ((group_data = faster_buffer_reader_next (group_reader)) != NULL) {
+         group_iter             group_it;
+         group_iter_init (&group_it, data);
+         while ((group_data = group_iter_next (&group_it)) != NULL) {
             type_selection (group_data, selection);
          }
-         faster_buffer_reader_close (group_reader);
       }
 
 }